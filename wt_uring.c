@@ -3,55 +3,630 @@
 #include <dirent.h>
 #include <dirent.h>
 #include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <linux/futex.h>
 #include <linux/stat.h>
 #include <pthread.h>
+#include <sched.h>
+#include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 #include "wiredtiger.h"
 #include "wiredtiger_ext.h"
 #include "liburing.h"
+#include "wt_uring.h"
 
+#ifndef JEB_NO_MAIN
 static const char *home;
 static const char *config;
+#endif
 
 #define EVENT_TYPE_SHUTDOWN 0
 #define EVENT_TYPE_NORMAL   1
 #define EVENT_TYPE_LINKED   2
+#define EVENT_TYPE_CHUNKED  3
+#define EVENT_TYPE_ASYNC    4   // nobody waits; ring_consumer recycles the slot itself
+#define EVENT_TYPE_DETACHED 5   // results go to a JEB_DETACHED; dispatch recycles the slot
 #define CQE_BATCH_SIZE      16
+// smallest queue_depth accepted: a durable rename across directories is a 3-SQE chain that
+// has to fit in the SQ in one go (see jeb_ring_get_sqes())
+#define QUEUE_DEPTH_MIN     4
+#define CQE_BATCH_MAX       256
+
+// trace records kept per thread unless trace=(records=N) says otherwise
+#define TRACE_RECORDS_DEFAULT   4096
+
+// admission=true without sizes: the window moves between ADMISSION_MIN_DEPTH and
+// queue_depth, backing off while completions average more than ADMISSION_TARGET_US
+#define ADMISSION_MIN_DEPTH     4
+#define ADMISSION_TARGET_US     1000
+// futex words admission waiters are spread over by ticket; tickets this far apart share
+// one and sometimes wake for nothing
+#define JEB_ADM_SLOTS           64
+
+// submit_batch=true without sizes
+#define SUBMIT_BATCH_ENTRIES    8
+#define SUBMIT_BATCH_WINDOW_US  20
+// polls of the SQ a batch leader makes before it sleeps out the rest of the window
+#define SUBMIT_BATCH_SPIN       64
+
+#define JEB_CACHE_LINE      64
+
+/* how callers get spread across the rings */
+#define RING_TOPOLOGY_CPU     0 // one ring per CPU, picked by sched_getcpu()
+#define RING_TOPOLOGY_NUMA    1 // one ring per NUMA node
+#define RING_TOPOLOGY_SESSION 2 // hash the WT_SESSION onto N rings
+
+#define JEB_MAX_RINGS       64
+
+#define REGBUF_DEFAULT_COUNT 64
+#define REGFILES_DEFAULT    4096
+
+/* which WT_FS_OPEN_FILE_TYPEs get opened with O_DIRECT */
+#define JEB_DIRECT_IO_DATA  0x1u
+#define JEB_DIRECT_IO_LOG   0x2u
+
+// aligned buffers kept around for O_DIRECT requests whose buffer isn't aligned;
+// anything bigger than a slot gets a one-off aligned allocation.
+#define BOUNCE_POOL_COUNT   16
+#define BOUNCE_POOL_SIZE    (256 * 1024)
+
+// a read/write is split into at most this many SQEs per batch. chunk SQEs carry their
+// index in the low bits of the (cache line aligned) completion slot pointer.
+#define JEB_CHUNK_MAX       64
+#define JEB_UD_TAG_MASK     ((uintptr_t)JEB_CACHE_LINE - 1)
+
+// largest single read/write we hand the kernel, same cap WT's posix layer uses
+#define JEB_CHUNK_LIMIT     ((size_t)1024 * 1024 * 1024)
+
+#define CHUNK_SIZE_DEFAULT  (256 * 1024)
+
+// parent directories kept open for remove/rename fsyncs; WT databases use very few
+#define JEB_DIRFD_CACHE     8
+
+// getdents64() buffer kept on the file system for directory listings
+#define DENTS_BUF_SIZE      (64 * 1024)
+
+// readahead: two windows ping-pong ahead of a reader once it has made this many
+// back-to-back sequential reads
+#define JEB_RA_WINDOWS      2
+#define JEB_RA_TRIGGER      2
+#define JEB_RA_MAX          (64 * 1024 * 1024)
+
+// block cache: entries are filed under the granule their offset falls in, so an overlapping
+// write only has to look at the granules it touches (and the one before). items bigger than
+// a granule aren't cached.
+#define JEB_BC_GRANULE_SHIFT 16
+#define JEB_BC_MAX_ITEM      ((size_t)1 << JEB_BC_GRANULE_SHIFT)
+#define JEB_BC_SHARDS        16
+
+// write combining: two staging buffers per handle, one filling while the other is written
+#define JEB_WC_MAX          (64 * 1024 * 1024)
+
+// metadata cache: fs_exist/fs_size answers filed by name. past JEB_META_MAX names, new
+// ones just aren't cached
+#define JEB_META_BUCKETS    1024
+#define JEB_META_MAX        16384
+
+// open prefetch: .wt files in a directory listing are opened ahead of WT asking, up to
+// JEB_CHUNK_MAX per batch. unclaimed fds are closed after timeout_ms. the files limit is
+// capped at half of RLIMIT_NOFILE so prefetching can't starve WT of descriptors.
+#define JEB_PF_BUCKETS      4096
+#define PREFETCH_OPEN_FILES 4096
+#define PREFETCH_OPEN_TIMEOUT_MS 60000
+#define JEB_PF_QUEUED       0 // waiting for the prefetch thread
+#define JEB_PF_OPENING      1 // openat in flight
+#define JEB_PF_OPEN         2 // fd ready for jeb_fs_open to claim
+
+// I/O classes (io_classes=...): per ring, at most class_depth[cls] reads/writes of a class
+// are in flight at once (0 is no limit), and their SQEs carry the class's ioprio. only the
+// best-effort ioprio class is used: real-time needs CAP_SYS_ADMIN and idle can starve a
+// checkpoint outright. the NULL session is WT's internal threads.
+#define JEB_CLASS_LOG        0 // log file writes
+#define JEB_CLASS_READ       1 // data reads from application sessions, and readahead
+#define JEB_CLASS_BACKGROUND 2 // data writes, NULL session reads, write-behind
+#define JEB_CLASSES          3
+#define JEB_CLASS_DEPTH_AUTO UINT32_MAX // background_depth not given: half of queue_depth
+#define JEB_IOPRIO_BE(level) ((uint16_t)((2 << 13) | (level))) // IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT
+
+// completion code a group commit leader uses to hand leadership to a waiting follower
+#define JEB_COMMIT_PROMOTED (-1)
+
+// used when the kernel can't tell us a file's O_DIRECT alignment
+#define DIO_DEFAULT_ALIGN   4096
+
+#define JEB_ALIGNED(v, a) (((uintptr_t)(v) & ((uintptr_t)(a) - 1)) == 0)
+
+// number of preallocated completion slots. every blocked caller holds exactly one; past
+// this many, slots are allocated one at a time and freed when they come back.
+#define UD_POOL_SIZE        1024
+
+// how many times a caller polls its slot before going to sleep on the futex
+#define UD_SPIN_COUNT       4096
+
+/* values of RING_EVENT_USER_DATA.lock_flag, the futex word */
+#define UD_PENDING          0
+#define UD_DONE             1
+#define UD_SLEEPING         2
+
+#if defined(__x86_64__) || defined(__i386__)
+#define JEB_CPU_RELAX() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define JEB_CPU_RELAX() __asm__ volatile("yield" ::: "memory")
+#else
+#define JEB_CPU_RELAX() __asm__ volatile("" ::: "memory")
+#endif
 
 /*
 * A wrapper struct to be used with io_uring SQEs and CQEs.
+*
+* These live in a preallocated pool owned by the file system and get recycled, so the
+* hot path never touches the allocator or pthread init/destroy. lock_flag is a futex word:
+* the caller spins on it for a bit, then parks in futex_wait(); ring_consumer flips it to
+* UD_DONE and only issues a futex_wake() if the caller actually went to sleep.
 */
 typedef struct __ring_event_user_data {
+    uint32_t lock_flag; // indicator to main thread to unblock
     int event_type;
-    int lock_flag; // indicator to main thread to unblock
-
-    // might just use posix cond vars ... or copy over WT's wr_condvar.
-    // tbh just need something that looks like a latch for now ...
-    pthread_mutex_t mutex;
-    pthread_cond_t condvar;
 
     // cqe->res value
     int ret_code;
-} RING_EVENT_USER_DATA;
 
+    // position of this slot in the pool
+    uint32_t idx;
 
-/* ! [JEB :: FILE_SYSTEM] */
-typedef struct __jeb_file_handle {
-    WT_FILE_SYSTEM iface;
+    // EVENT_TYPE_CHUNKED: chunk SQEs still in flight, and where each one's cqe->res goes
+    uint32_t pending;
+    int *chunk_res;
+
+    // CLOCK_MONOTONIC ns when the (last) CQE was reaped; only kept with stats on
+    uint64_t t_reap;
+
+    // CLOCK_MONOTONIC ns when the slot was handed out; only kept with admission on. callers
+    // get their slot after their credits, so this is when their SQEs were let in.
+    uint64_t t_start;
+    // CQEs tagged below this are reads/writes, the only ones admission takes latency from
+    uint32_t rw_tags;
+
+    // fire-and-forget ops: the ring whose class budget each SQE took one of, or NULL.
+    // dispatch hands it back CQE by CQE, see jeb_ud_class()
+    struct __jeb_ring *class_ring;
+    int class_id;
+
+    // EVENT_TYPE_DETACHED: where the CQEs' results go
+    struct __jeb_detached *detached;
+} __attribute__((aligned(JEB_CACHE_LINE))) RING_EVENT_USER_DATA;
+
+/*
+* The completion of a background op whose owner reaps it whenever it next comes back, which
+* may be never (an idle handle, a scan given up halfway). Its SQEs go out on an
+* EVENT_TYPE_DETACHED slot, but dispatch stores each CQE's result in res[tag] and recycles
+* the slot after the last one, so nothing from the pool waits on the owner. done works like
+* a slot's lock_flag.
+*/
+typedef struct __jeb_detached {
+    uint32_t done;
+    uint32_t pending;        // CQEs still to come
+    bool busy;               // issued and not reaped yet
+    int res[2];
+} JEB_DETACHED;
+
+/*
+* A lock-free LIFO of indices [0, n). The head packs an ABA tag in the upper 32 bits and
+* (index + 1) in the lower 32 bits, so zero means empty.
+*/
+typedef struct __jeb_freelist {
+    uint64_t head;
+    uint32_t *next;
+} JEB_FREELIST;
+
+/*
+* A set of equally-sized, page-aligned buffers carved out of one allocation and recycled
+* through a JEB_FREELIST. Slot i starts at base + i * slot_size.
+*/
+typedef struct __jeb_bufpool {
+    char *base;
+    size_t slot_size;
+    uint32_t nslots;
+    JEB_FREELIST free;
+} JEB_BUFPOOL;
 
-    // one ring to rule them all ...
+/*
+* One io_uring instance plus everything needed to drive it. Submission is serialized by
+* sq_lock (held from io_uring_get_sqe() until the SQE is submitted); completions are
+* harvested by the ring's own consumer thread, so reaping scales with the number of rings.
+*/
+typedef struct __jeb_ring {
     struct io_uring ring;
-    
+
     // eventfd used in conjunction with the uring
     int efd;
-    
+
     // a background thread that reads CQEs off the uring and notifies blocked callers
-    pthread_t uring_consumer; 
+    pthread_t uring_consumer;
+
+    pthread_mutex_t sq_lock;
+
+    // whoever drains the CQ holds cq_lock: ring_consumer, or with submitter_reap/iopoll the
+    // waiting threads themselves. IORING_SETUP_IOPOLL rings have no eventfd or consumer thread.
+    bool iopoll;
+    pthread_mutex_t cq_lock;
+    bool must_exit;          // the shutdown CQE has been reaped, ring_consumer should stop
+
+    // how far setup got, for jeb_rings_destroy()
+    bool initialized;        // io_uring_queue_init_params succeeded
+    bool consumer_running;   // uring_consumer was started
+
+    // set, under sq_lock, while some thread is holding the SQ open to collect a submit batch
+    bool batch_leader;
+    // futex word the leader sleeps on; the follower that brings the batch to batch_entries
+    // sets it and wakes the leader
+    uint32_t batch_full;
+
+    // reads/writes of each I/O class in flight, and threads waiting for some of them to
+    // finish. class_inflight doubles as the futex word those threads sleep on.
+    uint32_t class_inflight[JEB_CLASSES];
+    uint32_t class_waiters[JEB_CLASSES];
+
+    // credit admission (admission=...): SQEs let in and not yet reaped, and the window they're
+    // held to. callers queue by ticket, adm_next handed out and adm_serving the one whose
+    // turn it is. ticket t sleeps on adm_wait[t % JEB_ADM_SLOTS], which is bumped when t
+    // becomes the head, or when the head (wanting adm_head_n credits) now fits.
+    uint32_t adm_inflight;
+    uint32_t adm_limit;
+    uint32_t adm_next;
+    uint32_t adm_serving;
+    uint32_t adm_head_n;
+    uint32_t adm_wait[JEB_ADM_SLOTS];
+    bool adm_full;           // someone had to wait on the window this epoch
+    // completions so far this epoch and their summed latency, under cq_lock
+    uint32_t adm_lat_n;
+    uint64_t adm_lat_sum;
+
+    uint32_t id;
+    struct __jeb_file_handle *fs;
+} __attribute__((aligned(JEB_CACHE_LINE))) JEB_RING;
+
+/*
+* Tunables, parsed out of the extension's config string by jeb_config_parse().
+*/
+typedef struct __jeb_config {
+    uint32_t queue_depth;    // SQ entries per ring
+    uint32_t rings;          // 0 means one per CPU (or per NUMA node)
+    int ring_topology;
+
+    bool sqpoll;
+    uint32_t sqpoll_idle_ms;
+    int sqpoll_cpu;          // -1 lets the kernel place the SQPOLL thread
+
+    bool iopoll;             // O_DIRECT reads/writes go to a second set of IOPOLL rings
+    uint32_t iopoll_spin;    // fruitless polls/spins before an IOPOLL waiter yields the CPU
+    uint32_t cqe_batch;      // CQEs reaped between CQ head advances
+    bool submitter_reap;     // waiters drain the CQ themselves, ring_consumer is only a backstop
+    bool stats;              // per-thread op counters and latency histograms
+    uint32_t stats_log_wait; // seconds between appends to WiredTigerStat.uring, 0 disables
+    bool trace;              // per-thread trace rings, written to WiredTigerTrace.uring at terminate
+    uint32_t trace_records;  // records kept per thread, a power of two
+    uint32_t trace_sample;   // trace one in this many calls per thread
+    uint32_t batch_entries;  // publish a submit batch once this many SQEs are queued, 0 disables
+    uint32_t batch_window_us; // ... or once the first of them has waited this long
+    uint32_t direct_io;      // JEB_DIRECT_IO_* flags
+
+    uint32_t regbuf_count;   // number of registered buffer slots, 0 disables
+    uint64_t regbuf_size;    // bytes per registered buffer slot
+
+    uint32_t regfiles;       // size of the sparse registered file table, 0 disables
+
+    uint64_t chunk_size;     // reads/writes are split into SQEs of this size, 0 disables
+
+    bool group_commit;       // durable log writes share a linked write..fsync chain instead of O_DSYNC
+
+    uint64_t readahead;      // readahead window size for sequential readers, 0 disables
+
+    uint64_t write_combine;  // per-handle write-behind staging buffer size, 0 disables
+
+    uint64_t bcache_size;    // block cache byte budget, 0 disables
+    uint32_t bcache_shards;
+
+    bool metadata_cache;     // answer fh_size from the handle and fs_exist/fs_size from a name cache
+
+    uint32_t prefetch_files; // most speculative opens held at once, 0 disables
+    uint32_t prefetch_timeout_ms; // an unclaimed prefetched fd is closed after this long
+
+    uint64_t preallocate;    // space reserved past the end by fh_extend (FALLOC_FL_KEEP_SIZE), 0 disables
+
+    bool io_classes;         // budgets and ioprio per JEB_CLASS_*
+    uint32_t class_depth[JEB_CLASSES]; // in flight per ring, 0 is unlimited
+    int class_ioprio[JEB_CLASSES];     // best-effort level 0-7, -1 leaves the SQE's ioprio alone
+
+    bool admission;          // credit admission with an AIMD window per ring
+    uint32_t adm_min_depth;  // the window is never cut below this
+    uint32_t adm_max_depth;  // ... or grown above this, where it starts; 0 means queue_depth
+    uint32_t adm_target_us;  // average completion latency the window backs off above
+} JEB_CONFIG;
+
+/*
+* Counters bumped with relaxed atomics from the I/O paths. The ones bumped on every I/O
+* (dio_*, ra_*, submit*, meta_*) are only kept with stats=(enabled=true), in each thread's
+* JEB_THREAD_STATS, and summed in here at terminate; one shared cache line would have
+* every ring's callers fighting over it.
+*/
+typedef struct __jeb_fs_stats {
+    uint64_t dio_bounced;    // O_DIRECT requests staged through an aligned bounce buffer
+    uint64_t dio_unaligned;  // O_DIRECT requests with an unaligned offset/length, sent buffered
+    uint64_t ra_issued;      // readahead windows read
+    uint64_t ra_hits;        // fh_read calls served from a readahead window
+    uint64_t bc_inserts;     // blocks added to the block cache
+    uint64_t bc_evictions;   // blocks pushed out of the block cache by CLOCK
+    uint64_t submits;        // io_uring_submit calls made by the submit batcher
+    uint64_t submit_sqes;    // SQEs those calls published
+    uint64_t meta_hits;      // fs_exist/fs_size/fh_size calls answered without a statx
+    uint64_t meta_misses;    // ... and the ones that needed one
+    uint64_t pf_opened;      // files opened ahead by the prefetch thread
+    uint64_t pf_claimed;     // ... and handed to fs_open
+    uint64_t class_waits;    // reads/writes that had to wait for their class's budget
+    uint64_t adm_waits;      // submissions that had to wait for admission credits
+    uint64_t adm_cuts;       // times a ring's admission window was cut
+    uint64_t ud_overflow;    // completion slots allocated because the pool was empty
+} JEB_FS_STATS;
+
+
+#define JEB_STAT_INCR(fs, field) (void)__atomic_add_fetch(&(fs)->stats.field, 1, __ATOMIC_RELAXED)
+
+/* add v to one of the per-thread JEB_FS_STATS counters, when stats are on */
+#define JEB_TSTAT_INCR(fs, field, v) do {                                           \
+    JEB_THREAD_STATS *ts_;                                                          \
+    if ((fs)->cfg.stats && (ts_ = jeb_tstats_get(fs)) != NULL)                      \
+        JEB_TSTAT_ADD(&ts_->counters.field, (v));                                   \
+} while (0)
+
+/*
+* Per-thread operation stats (stats=(enabled=true)). Each thread that calls into the file
+* system gets its own JEB_THREAD_STATS and is the only one writing it, so recording is a few
+* relaxed stores; a dump sums every thread's copy. Latencies go into log-linear histograms
+* with four sub-buckets per power of two (HDR-ish, within 25%), in nanoseconds.
+*/
+#define JEB_OP_READ        WT_URING_OP_READ
+#define JEB_OP_WRITE       WT_URING_OP_WRITE
+#define JEB_OP_SYNC        WT_URING_OP_SYNC
+#define JEB_OP_OPEN        WT_URING_OP_OPEN
+#define JEB_OP_STATX       WT_URING_OP_STATX
+#define JEB_OP_FALLOCATE   WT_URING_OP_FALLOCATE
+#define JEB_OP_CLOSE       WT_URING_OP_CLOSE
+#define JEB_OPS            7 // ops the stats keep; the rest only show up in the trace
+#define JEB_OP_TRUNCATE    WT_URING_OP_TRUNCATE
+#define JEB_OP_REMOVE      WT_URING_OP_REMOVE
+#define JEB_OP_RENAME      WT_URING_OP_RENAME
+
+#define JEB_FTYPE_DATA     WT_URING_FTYPE_DATA
+#define JEB_FTYPE_LOG      WT_URING_FTYPE_LOG
+#define JEB_FTYPE_DIR      WT_URING_FTYPE_DIR
+#define JEB_FTYPE_OTHER    WT_URING_FTYPE_OTHER // checkpoint/regular files, and name-only calls like fs_exist
+#define JEB_FTYPES         4
+
+#define JEB_PHASE_TOTAL    0 // callback entry to return
+#define JEB_PHASE_QUEUE    1 // waiting for the SQ and getting SQEs published
+#define JEB_PHASE_SERVICE  2 // submitted until the CQE is reaped
+#define JEB_PHASE_WAKEUP   3 // CQE reaped until the caller is running again
+#define JEB_PHASES         4
+
+#define JEB_HIST_SUB_BITS  2
+#define JEB_HIST_BUCKETS   160 // up to 2^40ns, about 18 minutes; anything longer lands in the last
+
+typedef struct __jeb_hist {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t bucket[JEB_HIST_BUCKETS];
+} JEB_HIST;
+
+typedef struct __jeb_op_stats {
+    uint64_t ops;
+    uint64_t errors;
+    uint64_t bytes;
+    JEB_HIST lat[JEB_PHASES];
+} JEB_OP_STATS;
+
+typedef struct __jeb_thread_stats {
+    struct __jeb_thread_stats *next;
+    JEB_OP_STATS op[JEB_OPS][JEB_FTYPES];
+    JEB_FS_STATS counters;   // this thread's share of the per-I/O file system counters
+} JEB_THREAD_STATS;
+
+/*
+* A thread's trace records (trace=(enabled=true)), overwritten oldest first. Only the owning
+* thread writes. It bumps claim before overwriting a slot and head once the record is
+* complete, so a dump can tell which of the records it copied were being rewritten.
+*/
+typedef struct __jeb_trace_ring {
+    struct __jeb_trace_ring *next;
+    uint32_t tid;
+    uint32_t mask;           // records - 1, a power of two
+    uint64_t claim;          // records started
+    uint64_t head;           // records finished
+    WT_URING_TRACE_RECORD rec[];
+} JEB_TRACE_RING;
+/*
+* One committer's write waiting to go out in a log group commit. Lives on the committer's
+* stack; the leader completes ud with the write's result (0 or an errno).
+*/
+typedef struct __jeb_commit_req {
+    struct __jeb_commit_req *next;
+    const char *buf;
+    size_t len;
+    wt_off_t offset;
+    RING_EVENT_USER_DATA *ud;
+} JEB_COMMIT_REQ;
+
+/* an open directory, cached for fsyncing after a remove or rename in it */
+typedef struct __jeb_dirfd {
+    char *path;
+    int fd;
+} JEB_DIRFD;
+
+/* a buffer filled by an async read ahead of a sequential reader */
+typedef struct __jeb_ra_window {
+    char *buf;
+    wt_off_t off;
+    size_t len;                // bytes valid, once the read has been reaped
+    JEB_DETACHED io;           // the read, busy until reaped
+} JEB_RA_WINDOW;
+
+/*
+* A cached block. Entries sit in a hash chain (keyed by file and granule) and on their
+* shard's CLOCK ring.
+*/
+typedef struct __jeb_bc_entry {
+    uint64_t file_id;
+    wt_off_t off;
+    size_t len;
+    struct __jeb_bc_entry *hnext;
+    struct __jeb_bc_entry *prev, *next;  // CLOCK ring
+    bool ref;                            // CLOCK reference bit
+    char data[];
+} JEB_BC_ENTRY;
+
+typedef struct __jeb_bc_shard {
+    pthread_mutex_t lock;
+    JEB_BC_ENTRY **buckets;
+    uint32_t bucket_mask;
+    JEB_BC_ENTRY *hand;   // next CLOCK victim candidate; new entries go in just behind it
+    size_t bytes;
+    size_t budget;
+    uint64_t gen;         // bumped by every invalidation, so racing misses don't insert stale data
+    uint64_t hits;
+    uint64_t misses;
+} __attribute__((aligned(JEB_CACHE_LINE))) JEB_BC_SHARD;
+
+/* a contiguous run of staged writes, [off, off + len) of the file */
+typedef struct __jeb_wc_buf {
+    char *buf;
+    wt_off_t off;
+    size_t len;
+    JEB_DETACHED io;           // the background write, busy until reaped
+} JEB_WC_BUF;
+
+/*
+* What the metadata cache knows about a name. While handles are open on the file its size
+* can change under the cache, so it's only kept for closed files; with exactly one handle
+* open, fs_size asks that handle instead.
+*/
+typedef struct __jeb_meta_entry {
+    struct __jeb_meta_entry *next;
+    struct jeb_file_handle *fh;  // the handle open on the file if it's the only one, else NULL
+    uint32_t nopen;              // handles open on the file
+    int8_t exists;               // 1, 0, or -1 if not known
+    wt_off_t size;               // -1 if not known
+    char name[];
+} JEB_META_ENTRY;
+
+/*
+* A file a directory listing queued for opening ahead of WT. Entries are in the hash from
+* being queued until claimed, dropped or timed out; one that's dropped while queued or in
+* flight is freed by the prefetch thread when it gets back to it.
+*/
+typedef struct __jeb_pf_entry {
+    struct __jeb_pf_entry *hnext;
+    struct __jeb_pf_entry *qnext;  // pf_queue, while JEB_PF_QUEUED
+    int state;                     // JEB_PF_*
+    bool dropped;                  // out of the hash, the prefetch thread frees it
+    int fd;
+    uint64_t deadline_ns;          // JEB_PF_OPEN: closed if nobody claims it by then
+    char path[];
+} JEB_PF_ENTRY;
+
+/* ! [JEB :: FILE_SYSTEM] */
+typedef struct __jeb_file_handle {
+    WT_FILE_SYSTEM iface;
+
+    JEB_CONFIG cfg;
+
+    // the rings callers submit to; cfg.ring_topology says how a caller picks one
+    JEB_RING *rings;
+    uint32_t nrings;
+
+    // with iopoll, one IOPOLL ring per entry in rings[], NULL otherwise
+    JEB_RING *poll_rings;
+
+    // recycled completion slots handed out to callers waiting on the ring
+    RING_EVENT_USER_DATA *ud_pool;
+    JEB_FREELIST ud_free;
+
+    // arena registered with every ring (io_uring_register_buffers) for READ_FIXED/WRITE_FIXED;
+    // a slot's index in the pool is its buffer index in the rings.
+    JEB_BUFPOOL regbufs;
+
+    // aligned buffers for O_DIRECT requests that arrive with an unaligned buffer
+    JEB_BUFPOOL bounce;
+
+    JEB_FS_STATS stats;
+
+    // unique per process, never reused. threads key their cached stats block and trace ring
+    // on it rather than on our address, which a later file system can be allocated at
+    uint64_t id;
+
+    // with cfg.stats: every thread's op stats (push-only until terminate), and the thread
+    // appending them to stats_path every cfg.stats_log_wait seconds
+    JEB_THREAD_STATS *tstats;
+    char *stats_path;
+    pthread_t stats_thread;
+    pthread_mutex_t stats_lock;
+    pthread_cond_t stats_cond;
+    bool stats_stop;
+
+    // with cfg.trace: every thread's trace ring (push-only until terminate)
+    JEB_TRACE_RING *trace_rings;
+    char *trace_path;
+
+    // cached directory fds, only ever added to; closed at terminate
+    pthread_mutex_t dirfd_lock;
+    JEB_DIRFD dirfds[JEB_DIRFD_CACHE];
+    uint32_t ndirfds;
+
+    // block cache, NULL unless configured. file ids key it, so a reused handle address
+    // can't hit a closed file's entries
+    JEB_BC_SHARD *bcache;
+    uint64_t next_file_id;
+
+    // metadata cache, NULL unless configured. every change bumps meta_gen, so a statx that
+    // raced one doesn't put back what it replaced
+    pthread_mutex_t meta_lock;
+    JEB_META_ENTRY **meta;
+    uint32_t nmeta;
+    uint64_t meta_gen;
+
+    // open prefetch, NULL unless configured: opens queued by directory listings, the thread
+    // that works through them a batch at a time, and pf_done for fs_open callers waiting on
+    // one that's in flight
+    JEB_PF_ENTRY **pf;
+    JEB_PF_ENTRY *pf_queue, **pf_tailp;
+    uint32_t npf;
+    int pf_open_flags;
+    pthread_mutex_t pf_lock;
+    pthread_cond_t pf_cond;
+    pthread_cond_t pf_done;
+    pthread_t pf_thread;
+    bool pf_stop;
+
+    // getdents64() buffer shared by directory listings; a lister that finds it busy
+    // allocates its own
+    pthread_mutex_t dents_lock;
+    char *dents_buf;
+
+    // indices into the sparse file table registered with every ring. a handle owns the same
+    // index on all rings, so its SQEs can use IOSQE_FIXED_FILE no matter which ring they go to.
+    JEB_FREELIST file_slots;
+    uint32_t nfile_slots;
 
     WT_EXTENSION_API *wtext;
 } JEB_FILE_SYSTEM;
@@ -65,6 +640,81 @@ typedef struct jeb_file_handle {
 
     int fd;
 
+    // block cache key for this open
+    uint64_t file_id;
+
+    // index in the registered file table, -1 if the handle didn't get one. the fd is put in
+    // a ring's table the first time an SQE for it is prepped there, under that ring's
+    // sq_lock; bit <ring id> of fixed_rings[iopoll] says it's in, of fixed_tried that
+    // it's been attempted
+    int fixed_idx;
+    uint64_t fixed_rings[2];
+    uint64_t fixed_tried[2];
+
+    int open_flags;
+
+    // O_DIRECT handles: the alignment the kernel wants for buffers and for offsets/lengths,
+    // and a lazily opened buffered fd for requests whose offset or length isn't aligned.
+    bool direct_io;
+    uint32_t dio_mem_align;
+    uint32_t dio_offset_align;
+    int buffered_fd;
+    bool no_iopoll;          // the file's device/filesystem rejected a polled request
+
+    int stat_ftype;          // JEB_FTYPE_* this handle's ops are counted under
+    bool log_file;           // WT_FS_OPEN_FILE_TYPE_LOG, its I/O goes in JEB_CLASS_LOG
+
+    // with the metadata cache: the file's size as this handle has made it. writes and
+    // extends push it up (atomic max), truncate sets it; it's trusted once size_known,
+    // which the first statx or a truncate sets and a failed write clears.
+    wt_off_t size;
+    bool size_known;
+    bool meta_tracked;       // counted in the name's JEB_META_ENTRY
+
+    // writeback started by fh_sync_nowait that nobody has reaped yet, busy if there is one
+    pthread_mutex_t flush_lock;
+    JEB_DETACHED flush_io;
+
+    // fh_extend runs in the background: extend_io is the extension not yet reaped (busy if
+    // there is one), taking the file to extend_end (-1 until known); prealloc_end is where the
+    // space reserved past that with FALLOC_FL_KEEP_SIZE ends. a failure waits in extend_err
+    // for the next fh_extend or fh_sync.
+    pthread_mutex_t extend_lock;
+    JEB_DETACHED extend_io;
+    wt_off_t extend_end;
+    wt_off_t prealloc_end;
+    int extend_err;
+    bool no_prealloc;        // the file system doesn't do FALLOC_FL_KEEP_SIZE
+
+    // durable log files: writes queue up here and the current leader commits them as one
+    // chain of linked writes ending in an fdatasync
+    bool group_commit;
+    bool commit_leader;
+    pthread_mutex_t commit_lock;
+    JEB_COMMIT_REQ *commit_head, **commit_tailp;
+
+    // live mappings handed out by fh_map and the longest of them. truncate won't cut the
+    // file below a live mapping, touching those pages would SIGBUS.
+    pthread_mutex_t map_lock;
+    uint32_t nmaps;
+    size_t map_len;
+
+    // readahead (when configured): ra_next is where the next read starts if the reader is
+    // sequential, ra_streak how many in a row have been
+    pthread_mutex_t ra_lock;
+    JEB_RA_WINDOW ra[JEB_RA_WINDOWS];
+    wt_off_t ra_next;
+    uint32_t ra_streak;
+
+    // write-behind for data files (when configured): writes are copied into wc[wc_cur]
+    // and return; a full or non-contiguous run gets written in the background while the
+    // other buffer fills. wc_err holds a background write failure until the next sync.
+    bool wc_enabled;
+    pthread_mutex_t wc_lock;
+    JEB_WC_BUF wc[2];
+    uint32_t wc_cur;
+    int wc_err;
+
 } JEB_FILE_HANDLE;
 
 /* 
@@ -90,6 +740,7 @@ static int jeb_fs_terminate(WT_FILE_SYSTEM *, WT_SESSION *);
 /*
 * Forward function declarations for file handle API.
 */
+static int jeb_fh_advise(WT_FILE_HANDLE *, WT_SESSION *, wt_off_t, wt_off_t, int);
 static int jeb_fh_close(WT_FILE_HANDLE *, WT_SESSION *);
 static int jeb_fh_extend(WT_FILE_HANDLE *, WT_SESSION *, wt_off_t offset);
 static int jeb_fh_extend_nolock(WT_FILE_HANDLE *, WT_SESSION *, wt_off_t offset);
@@ -98,6 +749,10 @@ static int jeb_fh_read(WT_FILE_HANDLE *, WT_SESSION *, wt_off_t, size_t, void *)
 static int jeb_fh_size(WT_FILE_HANDLE *, WT_SESSION *, wt_off_t *);
 static int jeb_fh_sync(WT_FILE_HANDLE *, WT_SESSION *);
 static int jeb_fh_sync_nowait(WT_FILE_HANDLE *, WT_SESSION *);
+static void jeb_fh_flush_reap(JEB_FILE_HANDLE *, bool);
+static void jeb_fh_extend_reap(JEB_FILE_HANDLE *, bool);
+static uint64_t jeb_now_ns(void);
+static void jeb_class_exit(JEB_FILE_SYSTEM *, JEB_RING *, int, uint32_t);
 static int jeb_fh_truncate(WT_FILE_HANDLE *, WT_SESSION *, wt_off_t);
 static int jeb_fh_write(WT_FILE_HANDLE *, WT_SESSION *, wt_off_t, size_t, const void *);
 
@@ -107,106 +762,3741 @@ static int jeb_fh_map_preload(WT_FILE_HANDLE *, WT_SESSION *, const void *, size
 static int jeb_fh_unmap(WT_FILE_HANDLE *, WT_SESSION *, void *, size_t, void *);
 
 /*
-FILE_HANDLE functions not currently defined:
-
-fh_advise
-fh_extend
-fh_extend_nolock
+* set up a single ring. if attach_fd is a valid ring fd, share that ring's SQPOLL thread
+* and async workers rather than spawning another kernel poller per ring. returns an errno,
+* having cleaned up after itself.
 */
-
-int init_io_uring(struct io_uring *ring, int efd) {
+int init_io_uring(struct io_uring *ring, const JEB_CONFIG *cfg, int efd, int attach_fd, bool iopoll) {
     struct io_uring_params params;
 
-    if (geteuid()) {
-        fprintf(stderr, "You need root privileges to run this program.\n");
-        return 1;
-    }
     memset(&params, 0, sizeof(struct io_uring_params));
-    params.flags |= IORING_SETUP_SQPOLL;
-
-    // TODO: make idle time a config option?
-    params.sq_thread_idle = 120000; // 2 minutes in ms;
+    if (iopoll) {
+        // completions are polled by whoever is waiting, so no SQPOLL thread and no eventfd
+        params.flags |= IORING_SETUP_IOPOLL;
+    } else if (cfg->sqpoll) {
+        if (geteuid()) {
+            fprintf(stderr, "You need root privileges to run this program.\n");
+            return (EPERM);
+        }
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = cfg->sqpoll_idle_ms;
+        if (cfg->sqpoll_cpu >= 0) {
+            params.flags |= IORING_SETUP_SQ_AFF;
+            params.sq_thread_cpu = (uint32_t)cfg->sqpoll_cpu;
+        }
+    }
+    if (attach_fd >= 0) {
+        params.flags |= IORING_SETUP_ATTACH_WQ;
+        params.wq_fd = (uint32_t)attach_fd;
+    }
 
-    // TODO: make queue depth a config option?
-    int ret = io_uring_queue_init_params(16, ring, &params);
+    int ret = io_uring_queue_init_params(cfg->queue_depth, ring, &params);
     if (ret) {
         fprintf(stderr, "unable to setup uring: %s\n", strerror(-ret));
-        return 1;
+        return (-ret);
+    }
+    if (efd >= 0 && (ret = io_uring_register_eventfd(ring, efd)) < 0) {
+        fprintf(stderr, "unable to register eventfd with uring: %s\n", strerror(-ret));
+        io_uring_queue_exit(ring);
+        return (-ret);
     }
-    io_uring_register_eventfd(ring, efd);
 
     return 0;
 }
 
+/* ! [JEB :: COMPLETION SLOTS] */
+static int
+jeb_freelist_init(JEB_FREELIST *fl, uint32_t n) {
+    if ((fl->next = calloc(n, sizeof(uint32_t))) == NULL)
+        return (ENOMEM);
+
+    // chain every index together so the stack starts out full (entries hold index + 1, zero ends it)
+    for (uint32_t i = 0; i < n; i++)
+        fl->next[i] = i + 1 < n ? i + 2 : 0;
+    fl->head = n > 0 ? 1 : 0;
+    return (0);
+}
+
+static void
+jeb_freelist_destroy(JEB_FREELIST *fl) {
+    free(fl->next);
+    fl->next = NULL;
+    fl->head = 0;
+}
+
+/* pop an index off the free stack, returns false if it's empty */
+static bool
+jeb_freelist_pop(JEB_FREELIST *fl, uint32_t *idxp) {
+    uint64_t head, new_head;
+    uint32_t top;
+
+    head = __atomic_load_n(&fl->head, __ATOMIC_ACQUIRE);
+    do {
+        if ((top = (uint32_t)head) == 0)
+            return (false);
+        // next[] may be rewritten under us if someone else pops and pushes this index, but then
+        // the tag will have moved on and the CAS fails.
+        new_head = ((head >> 32) + 1) << 32 | __atomic_load_n(&fl->next[top - 1], __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(
+      &fl->head, &head, new_head, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    *idxp = top - 1;
+    return (true);
+}
+
+static void
+jeb_freelist_push(JEB_FREELIST *fl, uint32_t idx) {
+    uint64_t head, new_head;
+
+    head = __atomic_load_n(&fl->head, __ATOMIC_RELAXED);
+    do {
+        __atomic_store_n(&fl->next[idx], (uint32_t)head, __ATOMIC_RELAXED);
+        new_head = ((head >> 32) + 1) << 32 | (idx + 1);
+    } while (!__atomic_compare_exchange_n(
+      &fl->head, &head, new_head, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static inline void
+jeb_futex_wait(uint32_t *addr, uint32_t val) {
+    // EINTR/EAGAIN are fine, the caller re-checks the word in a loop
+    (void)syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static inline void
+jeb_futex_wait_timeout(uint32_t *addr, uint32_t val, uint64_t ns) {
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(ns / 1000000000);
+    ts.tv_nsec = (long)(ns % 1000000000);
+    (void)syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, &ts, NULL, 0);
+}
+
+static inline void
+jeb_futex_wake(uint32_t *addr) {
+    (void)syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+static inline void
+jeb_futex_wake_all(uint32_t *addr) {
+    (void)syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
 /*
-* function exxecuted by a bg thread to block on the eventfd, and when it awakens,
-* check the ring for CQEs. For each CQE available, poke the "lock"
-* in the user_data to awaken the blocked read/write thread.
-*
-* This thread will not free any memory.
+* grab a completion slot from the pool. if every slot is handed out (more than
+* UD_POOL_SIZE threads blocked on the ring), allocate one; only if that fails too,
+* yield until a slot comes back.
 */
-void *ring_consumer(void *data) {
-    struct io_uring_cqe *cqes[CQE_BATCH_SIZE];
-    struct io_uring_cqe *cqe;
-    JEB_FILE_SYSTEM *fs = (JEB_FILE_SYSTEM *) data;
+static RING_EVENT_USER_DATA *
+jeb_ud_get(JEB_FILE_SYSTEM *jeb_fs, int event_type) {
     RING_EVENT_USER_DATA *ud;
-    eventfd_t v;
+    uint32_t idx;
 
-    bool must_exit = false;
+    while (!jeb_freelist_pop(&jeb_fs->ud_free, &idx)) {
+        if ((ud = aligned_alloc(JEB_CACHE_LINE, sizeof(RING_EVENT_USER_DATA))) != NULL) {
+            JEB_STAT_INCR(jeb_fs, ud_overflow);
+            ud->idx = UINT32_MAX;
+            goto init;
+        }
+        sched_yield();
+    }
+    ud = &jeb_fs->ud_pool[idx];
+
+init:
+    ud->event_type = event_type;
+    ud->ret_code = 0;
+    ud->rw_tags = 0;
+    ud->class_ring = NULL;
+    if (jeb_fs->cfg.admission)
+        ud->t_start = jeb_now_ns();
+    __atomic_store_n(&ud->lock_flag, UD_PENDING, __ATOMIC_RELAXED);
+    return (ud);
+}
 
-    while (!must_exit) {
-        // this blocks forever ... i think :(
-        int ret = eventfd_read(fs->efd, &v);
-        if (ret < 0)
-            // TODO: find some better way to handle this error
-            exit(1);
-
-        // TODO: there's also io_uring_for_each_cqe()
-
-        // make sure we get all the CQEs that are ready, else we won't get 
-        // re-notified from the eventfd blocking
-        while (1) {
-            int cnt = io_uring_peek_batch_cqe(&fs->ring, cqes, CQE_BATCH_SIZE);
-            if (!cnt) {
-                // not sure when we'd get 0 count if the eventfd triggered, unless spurious :shrug:
-                break;
+static void
+jeb_ud_put(JEB_FILE_SYSTEM *jeb_fs, RING_EVENT_USER_DATA *ud) {
+    if (ud->idx == UINT32_MAX)
+        free(ud);
+    else
+        jeb_freelist_push(&jeb_fs->ud_free, ud->idx);
+}
+
+/* flip a completion word to UD_DONE, waking its waiter if it went to sleep */
+static inline void
+jeb_done_set(uint32_t *flag) {
+    if (__atomic_exchange_n(flag, UD_DONE, __ATOMIC_ACQ_REL) == UD_SLEEPING)
+        jeb_futex_wake(flag);
+}
+
+/*
+* called by whoever reaps the CQE. once lock_flag flips to UD_DONE the waiter may
+* recycle the slot, so nothing in ud can be touched after the exchange.
+*/
+static void
+jeb_ud_complete(RING_EVENT_USER_DATA *ud, int res) {
+    ud->ret_code = res;
+    jeb_done_set(&ud->lock_flag);
+}
+
+/*
+* one chunk of an EVENT_TYPE_CHUNKED group finished; the last one completes the slot.
+*/
+static void
+jeb_ud_chunk_complete(RING_EVENT_USER_DATA *ud, uint32_t chunk, int res) {
+    ud->chunk_res[chunk] = res;
+    if (__atomic_sub_fetch(&ud->pending, 1, __ATOMIC_ACQ_REL) == 0)
+        jeb_ud_complete(ud, 0);
+}
+
+/* block until a completion word flips to UD_DONE */
+static void
+jeb_done_wait(uint32_t *flag) {
+    uint32_t state;
+
+    for (int i = 0; i < UD_SPIN_COUNT; i++) {
+        if (__atomic_load_n(flag, __ATOMIC_ACQUIRE) == UD_DONE)
+            return;
+        JEB_CPU_RELAX();
+    }
+
+    // announce we're going to sleep; if the CQE beat us to it we're done
+    state = UD_PENDING;
+    if (__atomic_compare_exchange_n(
+      flag, &state, UD_SLEEPING, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        state = UD_SLEEPING;
+    }
+
+    // loop to deal with spurious wakeups (and signals)
+    while (state != UD_DONE) {
+        jeb_futex_wait(flag, UD_SLEEPING);
+        state = __atomic_load_n(flag, __ATOMIC_ACQUIRE);
+    }
+}
+
+/* block until the slot is completed, returns cqe->res */
+static int
+jeb_ud_wait(RING_EVENT_USER_DATA *ud) {
+    jeb_done_wait(&ud->lock_flag);
+    return (ud->ret_code);
+}
+
+/* a slot for n SQEs whose results go to d. d mustn't be busy */
+static RING_EVENT_USER_DATA *
+jeb_ud_get_detached(JEB_FILE_SYSTEM *jeb_fs, JEB_DETACHED *d, uint32_t n) {
+    RING_EVENT_USER_DATA *ud;
+
+    ud = jeb_ud_get(jeb_fs, EVENT_TYPE_DETACHED);
+    ud->detached = d;
+    d->res[0] = d->res[1] = 0;
+    d->pending = n;
+    __atomic_store_n(&d->done, UD_PENDING, __ATOMIC_RELAXED);
+    __atomic_store_n(&d->busy, true, __ATOMIC_RELEASE);
+    return (ud);
+}
+
+/* true once every CQE of d's op is in */
+static inline bool
+jeb_detached_done(JEB_DETACHED *d) {
+    return (__atomic_load_n(&d->done, __ATOMIC_ACQUIRE) == UD_DONE);
+}
+
+/* wait for d's op and mark it reaped; its results are in d->res. false if nothing was issued */
+static bool
+jeb_detached_reap(JEB_DETACHED *d) {
+    if (!d->busy)
+        return (false);
+    jeb_done_wait(&d->done);
+    __atomic_store_n(&d->busy, false, __ATOMIC_RELEASE);
+    return (true);
+}
+
+/* ! [JEB :: STATS] */
+/* the op the calling thread is in the middle of, if it's being timed */
+typedef struct __jeb_op_ctx {
+    bool active;
+    bool traced;
+    uint64_t start;          // callback entry
+    uint64_t mark;           // end of the last wait (or start), where queueing restarts
+    uint64_t submitted;      // last time our SQEs went to the ring
+    uint32_t nsubmits;
+    uint64_t phase[JEB_PHASES];
+} JEB_OP_CTX;
+
+static __thread JEB_OP_CTX jeb_op;
+static __thread JEB_THREAD_STATS *jeb_tstats;
+static __thread uint64_t jeb_tstats_fs_id;
+#ifndef JEB_NO_TRACE
+static __thread JEB_TRACE_RING *jeb_trace_ring;
+static __thread uint64_t jeb_trace_ring_fs_id;
+static __thread uint32_t jeb_trace_seq;
+#endif
+
+// source of JEB_FILE_SYSTEM.id; 0 is never handed out
+static uint64_t jeb_fs_next_id;
+
+// the file systems wt_uring_stats_dump() and wt_uring_trace_dump() report on
+static JEB_FILE_SYSTEM *jeb_stats_fs;
+#ifndef JEB_NO_TRACE
+static JEB_FILE_SYSTEM *jeb_trace_fs;
+#endif
+
+static const char *jeb_op_names[JEB_OPS] =
+  {"read", "write", "sync", "open", "statx", "fallocate", "close"};
+static const char *jeb_ftype_names[JEB_FTYPES] = {"data", "log", "directory", "other"};
+static const char *jeb_phase_names[JEB_PHASES] = {"latency", "queue wait", "service", "wakeup"};
+
+/* monotonic nanoseconds */
+static uint64_t
+jeb_now_ns(void) {
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec);
+}
+
+static int
+jeb_stat_ftype(WT_FS_OPEN_FILE_TYPE file_type) {
+    switch (file_type) {
+    case WT_FS_OPEN_FILE_TYPE_DATA:
+        return (JEB_FTYPE_DATA);
+    case WT_FS_OPEN_FILE_TYPE_LOG:
+        return (JEB_FTYPE_LOG);
+    case WT_FS_OPEN_FILE_TYPE_DIRECTORY:
+        return (JEB_FTYPE_DIR);
+    default:
+        return (JEB_FTYPE_OTHER);
+    }
+}
+
+/* histogram bucket for v: exact below 4, then 4 buckets per power of two */
+static uint32_t
+jeb_hist_bucket(uint64_t v) {
+    uint32_t idx, msb;
+
+    if (v < (1 << JEB_HIST_SUB_BITS))
+        return ((uint32_t)v);
+    msb = 63 - (uint32_t)__builtin_clzll(v);
+    idx = ((msb - JEB_HIST_SUB_BITS + 1) << JEB_HIST_SUB_BITS) +
+      (uint32_t)((v >> (msb - JEB_HIST_SUB_BITS)) & ((1 << JEB_HIST_SUB_BITS) - 1));
+    return (idx < JEB_HIST_BUCKETS ? idx : JEB_HIST_BUCKETS - 1);
+}
+
+/* the largest value that lands in bucket idx */
+static uint64_t
+jeb_hist_bucket_max(uint32_t idx) {
+    uint32_t shift;
+
+    if (idx < (1 << JEB_HIST_SUB_BITS))
+        return (idx);
+    shift = (idx >> JEB_HIST_SUB_BITS) - 1;
+    return ((((uint64_t)(idx & ((1 << JEB_HIST_SUB_BITS) - 1)) + (1 << JEB_HIST_SUB_BITS) + 1) << shift) - 1);
+}
+
+/* only the owning thread writes, but a dump may be reading concurrently */
+#define JEB_TSTAT_ADD(p, v) __atomic_store_n((p), __atomic_load_n((p), __ATOMIC_RELAXED) + (v), __ATOMIC_RELAXED)
+
+static void
+jeb_hist_record(JEB_HIST *h, uint64_t v) {
+    JEB_TSTAT_ADD(&h->count, 1);
+    JEB_TSTAT_ADD(&h->sum, v);
+    JEB_TSTAT_ADD(&h->bucket[jeb_hist_bucket(v)], 1);
+    if (v > h->max)
+        __atomic_store_n(&h->max, v, __ATOMIC_RELAXED);
+}
+
+/* this thread's stats block, registering a new one on first use */
+static JEB_THREAD_STATS *
+jeb_tstats_get(JEB_FILE_SYSTEM *jeb_fs) {
+    JEB_THREAD_STATS *ts;
+
+    if (jeb_tstats_fs_id == jeb_fs->id)
+        return (jeb_tstats);
+    if ((ts = calloc(1, sizeof(JEB_THREAD_STATS))) == NULL)
+        return (NULL);
+    ts->next = __atomic_load_n(&jeb_fs->tstats, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(
+      &jeb_fs->tstats, &ts->next, ts, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        ;
+    jeb_tstats = ts;
+    jeb_tstats_fs_id = jeb_fs->id;
+    return (ts);
+}
+
+/* ! [JEB :: TRACE] */
+#ifndef JEB_NO_TRACE
+/* this thread's trace ring, registering a new one on first use */
+static JEB_TRACE_RING *
+jeb_trace_ring_get(JEB_FILE_SYSTEM *jeb_fs) {
+    JEB_TRACE_RING *tr;
+
+    if (jeb_trace_ring_fs_id == jeb_fs->id)
+        return (jeb_trace_ring);
+    if ((tr = calloc(1, sizeof(JEB_TRACE_RING) +
+      jeb_fs->cfg.trace_records * sizeof(WT_URING_TRACE_RECORD))) == NULL)
+        return (NULL);
+    tr->tid = (uint32_t)syscall(SYS_gettid);
+    tr->mask = jeb_fs->cfg.trace_records - 1;
+    tr->next = __atomic_load_n(&jeb_fs->trace_rings, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(
+      &jeb_fs->trace_rings, &tr->next, tr, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        ;
+    jeb_trace_ring = tr;
+    jeb_trace_ring_fs_id = jeb_fs->id;
+    return (tr);
+}
+
+#define JEB_SAT32(v) ((v) > UINT32_MAX ? UINT32_MAX : (uint32_t)(v))
+
+/* append the op the thread just finished to its trace ring */
+static void
+jeb_trace_record(JEB_FILE_SYSTEM *jeb_fs, int op, int ftype, int fd, wt_off_t offset, size_t len,
+    int ret, uint64_t now) {
+    JEB_TRACE_RING *tr;
+    WT_URING_TRACE_RECORD *r;
+    uint64_t seq;
+
+    if ((tr = jeb_trace_ring_get(jeb_fs)) == NULL)
+        return;
+    seq = tr->head;
+    __atomic_store_n(&tr->claim, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    r = &tr->rec[seq & tr->mask];
+    r->start_ns = jeb_op.start;
+    r->end_ns = now;
+    r->offset = (int64_t)offset;
+    r->len = len;
+    r->queue_ns = JEB_SAT32(jeb_op.phase[JEB_PHASE_QUEUE]);
+    r->service_ns = JEB_SAT32(jeb_op.phase[JEB_PHASE_SERVICE]);
+    r->fd = fd;
+    r->result = ret;
+    r->op = (uint16_t)op;
+    r->file_type = (uint16_t)ftype;
+    r->pad = 0;
+    __atomic_store_n(&tr->head, seq + 1, __ATOMIC_RELEASE);
+}
+
+/* write every thread's ring to path, in the layout described in wt_uring.h */
+static int
+jeb_trace_write(JEB_FILE_SYSTEM *jeb_fs, const char *path) {
+    WT_URING_TRACE_HEADER hdr;
+    WT_URING_TRACE_RECORD *buf;
+    WT_URING_TRACE_THREAD th;
+    JEB_TRACE_RING *tr;
+    FILE *fp;
+    uint64_t claim, head, lo, skip;
+    int ret = 0;
+
+    if ((buf = malloc(jeb_fs->cfg.trace_records * sizeof(WT_URING_TRACE_RECORD))) == NULL)
+        return (ENOMEM);
+    if ((fp = fopen(path, "w")) == NULL) {
+        ret = errno;
+        free(buf);
+        return (ret);
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, WT_URING_TRACE_MAGIC, sizeof(hdr.magic));
+    hdr.version = WT_URING_TRACE_VERSION;
+    hdr.record_size = sizeof(WT_URING_TRACE_RECORD);
+    if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+        ret = EIO;
+
+    for (tr = __atomic_load_n(&jeb_fs->trace_rings, __ATOMIC_ACQUIRE); tr != NULL && ret == 0;
+      tr = tr->next) {
+        head = __atomic_load_n(&tr->head, __ATOMIC_ACQUIRE);
+        lo = head > tr->mask + 1 ? head - (tr->mask + 1) : 0;
+        for (uint64_t i = lo; i < head; i++)
+            memcpy(&buf[i - lo], &tr->rec[i & tr->mask], sizeof(WT_URING_TRACE_RECORD));
+
+        // anything the owner has started overwriting since we read head is suspect
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        claim = __atomic_load_n(&tr->claim, __ATOMIC_RELAXED);
+        skip = claim > tr->mask + 1 && claim - (tr->mask + 1) > lo ? claim - (tr->mask + 1) - lo : 0;
+        if (skip >= head - lo)
+            continue;
+
+        th.tid = tr->tid;
+        th.count = (uint32_t)(head - lo - skip);
+        if (fwrite(&th, sizeof(th), 1, fp) != 1 ||
+          fwrite(buf + skip, sizeof(WT_URING_TRACE_RECORD), th.count, fp) != th.count)
+            ret = EIO;
+    }
+    if (fclose(fp) != 0 && ret == 0)
+        ret = errno;
+    free(buf);
+    return (ret);
+}
+
+static int
+jeb_trace_init(JEB_FILE_SYSTEM *jeb_fs, WT_CONNECTION *conn) {
+    const char *dir;
+    size_t len;
+
+    dir = conn->get_home(conn);
+    len = strlen(dir) + sizeof("/WiredTigerTrace.uring");
+    if ((jeb_fs->trace_path = malloc(len)) == NULL)
+        return (ENOMEM);
+    (void)snprintf(jeb_fs->trace_path, len, "%s/WiredTigerTrace.uring", dir);
+    __atomic_store_n(&jeb_trace_fs, jeb_fs, __ATOMIC_RELEASE);
+    return (0);
+}
+
+/* write out what's in the rings and free them. by now no other thread is calling in */
+static void
+jeb_trace_destroy(JEB_FILE_SYSTEM *jeb_fs) {
+    JEB_TRACE_RING *tr, *next;
+    int ret;
+
+    if (!jeb_fs->cfg.trace)
+        return;
+    __atomic_store_n(&jeb_trace_fs, NULL, __ATOMIC_RELEASE);
+    if (jeb_fs->trace_path != NULL && (ret = jeb_trace_write(jeb_fs, jeb_fs->trace_path)) != 0)
+        fprintf(stderr, "failed to write the trace to %s: %s\n", jeb_fs->trace_path, strerror(ret));
+    free(jeb_fs->trace_path);
+    for (tr = jeb_fs->trace_rings; tr != NULL; tr = next) {
+        next = tr->next;
+        free(tr);
+    }
+    jeb_fs->trace_rings = NULL;
+}
+#endif
+
+int
+wt_uring_trace_dump(const char *path) {
+#ifdef JEB_NO_TRACE
+    (void)path;
+    return (ENOENT);
+#else
+    JEB_FILE_SYSTEM *jeb_fs;
+
+    if ((jeb_fs = __atomic_load_n(&jeb_trace_fs, __ATOMIC_ACQUIRE)) == NULL)
+        return (ENOENT);
+    return (jeb_trace_write(jeb_fs, path));
+#endif
+}
+/* ! [JEB :: TRACE] */
+
+/*
+* start timing the calling thread's op, if stats are on or it's one of the traced ones.
+* otherwise everything down to jeb_op_end() is a flag check.
+*/
+static void
+jeb_op_begin(JEB_FILE_SYSTEM *jeb_fs) {
+    memset(&jeb_op, 0, sizeof(jeb_op));
+#ifndef JEB_NO_TRACE
+    if (jeb_fs->cfg.trace && ++jeb_trace_seq % jeb_fs->cfg.trace_sample == 0)
+        jeb_op.traced = true;
+#endif
+    if (!jeb_fs->cfg.stats && !jeb_op.traced)
+        return;
+    jeb_op.active = true;
+    jeb_op.start = jeb_op.mark = jeb_now_ns();
+}
+
+/* our SQEs are on their way to the kernel: close out the time spent getting there */
+static void
+jeb_op_submitted(void) {
+    uint64_t now;
+
+    if (!jeb_op.active)
+        return;
+    now = jeb_now_ns();
+    jeb_op.phase[JEB_PHASE_QUEUE] += now - jeb_op.mark;
+    jeb_op.submitted = now;
+    ++jeb_op.nsubmits;
+}
+
+/* the ring wait for ud just returned; split it into service time and wakeup delay */
+static void
+jeb_op_waited(RING_EVENT_USER_DATA *ud) {
+    uint64_t now;
+
+    if (!jeb_op.active || jeb_op.submitted == 0)
+        return;
+    now = jeb_now_ns();
+    if (ud->t_reap > jeb_op.submitted) {
+        jeb_op.phase[JEB_PHASE_SERVICE] += ud->t_reap - jeb_op.submitted;
+        jeb_op.phase[JEB_PHASE_WAKEUP] += now > ud->t_reap ? now - ud->t_reap : 0;
+    }
+    jeb_op.mark = now;
+}
+
+static void
+jeb_op_end(JEB_FILE_SYSTEM *jeb_fs, int op, int ftype, int fd, wt_off_t offset, size_t bytes,
+    int ret) {
+    JEB_OP_STATS *os;
+    JEB_THREAD_STATS *ts;
+    uint64_t now;
+
+    if (!jeb_op.active)
+        return;
+    jeb_op.active = false;
+    now = jeb_now_ns();
+#ifndef JEB_NO_TRACE
+    if (jeb_op.traced)
+        jeb_trace_record(jeb_fs, op, ftype, fd, offset, bytes, ret, now);
+#endif
+
+    if (!jeb_fs->cfg.stats || op >= JEB_OPS || (ts = jeb_tstats_get(jeb_fs)) == NULL)
+        return;
+    os = &ts->op[op][ftype];
+    JEB_TSTAT_ADD(&os->ops, 1);
+    if (ret != 0)
+        JEB_TSTAT_ADD(&os->errors, 1);
+    else
+        JEB_TSTAT_ADD(&os->bytes, bytes);
+    jeb_hist_record(&os->lat[JEB_PHASE_TOTAL], now - jeb_op.start);
+    // ops answered without the ring (a cache hit, say) would only drag the phase histograms to zero
+    if (jeb_op.nsubmits != 0)
+        for (int i = JEB_PHASE_QUEUE; i < JEB_PHASES; i++)
+            jeb_hist_record(&os->lat[i], jeb_op.phase[i]);
+}
+
+/* the value below which fraction q of h's samples fall */
+static uint64_t
+jeb_hist_quantile(const JEB_HIST *h, double q) {
+    uint64_t seen = 0, target;
+
+    if (h->count == 0)
+        return (0);
+    target = (uint64_t)(q * (double)h->count);
+    for (uint32_t i = 0; i < JEB_HIST_BUCKETS; i++)
+        if ((seen += h->bucket[i]) > target)
+            return (jeb_hist_bucket_max(i) < h->max ? jeb_hist_bucket_max(i) : h->max);
+    return (h->max);
+}
+
+static void
+jeb_stats_line(FILE *fp, const char *stamp, uint64_t value, int op, int ftype, const char *metric) {
+    // the statistics_log text layout: "<time> <value> <source> <description>"
+    if (stamp != NULL)
+        fprintf(fp, "%s %" PRIu64 " uring %s %s: %s\n",
+          stamp, value, jeb_ftype_names[ftype], jeb_op_names[op], metric);
+    else
+        fprintf(fp, "%-9s %-9s %-24s %" PRIu64 "\n",
+          jeb_ftype_names[ftype], jeb_op_names[op], metric, value);
+}
+
+/*
+* write every op/file type that's seen any calls, summed over all threads. stamp NULL is the
+* readable layout for wt_uring_stats_dump(), otherwise lines are in statistics_log's layout.
+*/
+static void
+jeb_stats_write(JEB_FILE_SYSTEM *jeb_fs, FILE *fp, const char *stamp) {
+    static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    static const char *qnames[] = {"p50", "p90", "p99", "p99.9"};
+    JEB_OP_STATS sum;
+    JEB_THREAD_STATS *ts;
+    char metric[64];
+    const JEB_HIST *h;
+
+    for (int op = 0; op < JEB_OPS; op++)
+        for (int ft = 0; ft < JEB_FTYPES; ft++) {
+            memset(&sum, 0, sizeof(sum));
+            for (ts = __atomic_load_n(&jeb_fs->tstats, __ATOMIC_ACQUIRE); ts != NULL; ts = ts->next) {
+                const JEB_OP_STATS *os = &ts->op[op][ft];
+                sum.ops += __atomic_load_n(&os->ops, __ATOMIC_RELAXED);
+                sum.errors += __atomic_load_n(&os->errors, __ATOMIC_RELAXED);
+                sum.bytes += __atomic_load_n(&os->bytes, __ATOMIC_RELAXED);
+                for (int p = 0; p < JEB_PHASES; p++) {
+                    sum.lat[p].count += __atomic_load_n(&os->lat[p].count, __ATOMIC_RELAXED);
+                    sum.lat[p].sum += __atomic_load_n(&os->lat[p].sum, __ATOMIC_RELAXED);
+                    if (os->lat[p].max > sum.lat[p].max)
+                        sum.lat[p].max = __atomic_load_n(&os->lat[p].max, __ATOMIC_RELAXED);
+                    for (uint32_t b = 0; b < JEB_HIST_BUCKETS; b++)
+                        sum.lat[p].bucket[b] += __atomic_load_n(&os->lat[p].bucket[b], __ATOMIC_RELAXED);
+                }
             }
-//            printf("JEB::ring_consumer - next batch count = %d\n", cnt);
-            
-            cqe = *cqes;
-            for (int i = 0; i < cnt; i++, cqe++) {
-                ud = io_uring_cqe_get_data(cqe);
-                // NOTE: there could be some nasty thread blocks here if the timing is unlucky 
-                // (if the producing thread hasn't called pthread_cond_wait() yet).
-                pthread_mutex_lock(&ud->mutex); // <- i think i need to do this, but not sure yet (or do it at submission??)
-                ud->ret_code = cqe->res;
-                pthread_cond_signal(&ud->condvar);
-                pthread_mutex_unlock(&ud->mutex);
-
-                if (ud->event_type == EVENT_TYPE_SHUTDOWN) {
-                    must_exit = true;
+            if (sum.ops == 0)
+                continue;
+
+            jeb_stats_line(fp, stamp, sum.ops, op, ft, "calls");
+            jeb_stats_line(fp, stamp, sum.errors, op, ft, "errors");
+            if (op == JEB_OP_READ || op == JEB_OP_WRITE)
+                jeb_stats_line(fp, stamp, sum.bytes, op, ft, "bytes");
+            for (int p = 0; p < JEB_PHASES; p++) {
+                h = &sum.lat[p];
+                if (h->count == 0)
+                    continue;
+                (void)snprintf(metric, sizeof(metric), "%s mean (ns)", jeb_phase_names[p]);
+                jeb_stats_line(fp, stamp, h->sum / h->count, op, ft, metric);
+                for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); q++) {
+                    (void)snprintf(metric, sizeof(metric), "%s %s (ns)", jeb_phase_names[p], qnames[q]);
+                    jeb_stats_line(fp, stamp, jeb_hist_quantile(h, quantiles[q]), op, ft, metric);
                 }
-
-                // TODO: see if there's a way to batch update the pointer here, instead of doing it one at a time.
-                // io_uring_for_each_cqe() has a helper function to do that, i think ....
-                io_uring_cqe_seen(&fs->ring, cqe);
+                (void)snprintf(metric, sizeof(metric), "%s max (ns)", jeb_phase_names[p]);
+                jeb_stats_line(fp, stamp, h->max, op, ft, metric);
             }
         }
+}
+
+int
+wt_uring_stats_dump(FILE *fp) {
+    JEB_FILE_SYSTEM *jeb_fs;
+
+    if ((jeb_fs = __atomic_load_n(&jeb_stats_fs, __ATOMIC_ACQUIRE)) == NULL)
+        return (ENOENT);
+    jeb_stats_write(jeb_fs, fp, NULL);
+    return (fflush(fp) == 0 ? 0 : errno);
+}
+
+/*
+* append the stats to stats_path every stats_log_wait seconds, next to WT's own
+* WiredTigerStat.* files and in the same line layout, so the same tools can read both.
+*/
+static void *
+jeb_stats_log_thread(void *data) {
+    JEB_FILE_SYSTEM *jeb_fs = (JEB_FILE_SYSTEM *)data;
+    FILE *fp;
+    struct timespec deadline;
+    struct tm tm;
+    time_t now;
+    char stamp[64];
+
+    pthread_mutex_lock(&jeb_fs->stats_lock);
+    while (!jeb_fs->stats_stop) {
+        (void)clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += jeb_fs->cfg.stats_log_wait;
+        while (!jeb_fs->stats_stop &&
+          pthread_cond_timedwait(&jeb_fs->stats_cond, &jeb_fs->stats_lock, &deadline) == 0)
+            ;
+        if (jeb_fs->stats_stop)
+            break;
+
+        now = time(NULL);
+        (void)localtime_r(&now, &tm);
+        (void)strftime(stamp, sizeof(stamp), "%b %d %H:%M:%S", &tm);
+        if ((fp = fopen(jeb_fs->stats_path, "a")) == NULL) {
+            fprintf(stderr, "failed to open %s: %s\n", jeb_fs->stats_path, strerror(errno));
+            continue;
+        }
+        jeb_stats_write(jeb_fs, fp, stamp);
+        (void)fclose(fp);
+    }
+    pthread_mutex_unlock(&jeb_fs->stats_lock);
+    return (NULL);
+}
+
+static int
+jeb_stats_init(JEB_FILE_SYSTEM *jeb_fs, WT_CONNECTION *conn) {
+    const char *dir;
+    size_t len;
+    int ret;
+
+    __atomic_store_n(&jeb_stats_fs, jeb_fs, __ATOMIC_RELEASE);
+    if (jeb_fs->cfg.stats_log_wait == 0)
+        return (0);
+
+    dir = conn->get_home(conn);
+    len = strlen(dir) + sizeof("/WiredTigerStat.uring");
+    if ((jeb_fs->stats_path = malloc(len)) == NULL)
+        return (ENOMEM);
+    (void)snprintf(jeb_fs->stats_path, len, "%s/WiredTigerStat.uring", dir);
+
+    pthread_mutex_init(&jeb_fs->stats_lock, NULL);
+    pthread_cond_init(&jeb_fs->stats_cond, NULL);
+    if ((ret = pthread_create(&jeb_fs->stats_thread, NULL, jeb_stats_log_thread, jeb_fs)) != 0) {
+        free(jeb_fs->stats_path);
+        jeb_fs->stats_path = NULL;
+        return (ret);
+    }
+    return (0);
+}
+
+static void
+jeb_stats_destroy(JEB_FILE_SYSTEM *jeb_fs) {
+    JEB_THREAD_STATS *ts, *next;
+
+    if (!jeb_fs->cfg.stats)
+        return;
+    if (jeb_fs->stats_path != NULL) {
+        pthread_mutex_lock(&jeb_fs->stats_lock);
+        jeb_fs->stats_stop = true;
+        pthread_cond_signal(&jeb_fs->stats_cond);
+        pthread_mutex_unlock(&jeb_fs->stats_lock);
+        (void)pthread_join(jeb_fs->stats_thread, NULL);
+        pthread_mutex_destroy(&jeb_fs->stats_lock);
+        pthread_cond_destroy(&jeb_fs->stats_cond);
+        free(jeb_fs->stats_path);
+    }
+    __atomic_store_n(&jeb_stats_fs, NULL, __ATOMIC_RELEASE);
+    for (ts = jeb_fs->tstats; ts != NULL; ts = next) {
+        next = ts->next;
+        // every field is a uint64_t; the ones not counted per thread are just zero here
+        for (size_t i = 0; i < sizeof(JEB_FS_STATS) / sizeof(uint64_t); i++)
+            ((uint64_t *)&jeb_fs->stats)[i] += ((uint64_t *)&ts->counters)[i];
+        free(ts);
+    }
+    jeb_fs->tstats = NULL;
+}
+
+/*
+* with stats or tracing on, these go in the WT_FILE_SYSTEM/WT_FILE_HANDLE tables in place of
+* the plain callbacks, so an uninstrumented table pays nothing.
+*/
+#define JEB_FH_TIMED(fh, op, offset, bytes, call) do {                              \
+    JEB_FILE_HANDLE *jfh_ = (JEB_FILE_HANDLE *)(fh);                                \
+    JEB_FILE_SYSTEM *jfs_ = jfh_->fs;                                               \
+    int fd_ = jfh_->fd, ftype_ = jfh_->stat_ftype, ret_;                            \
+    jeb_op_begin(jfs_);                                                             \
+    ret_ = (call);                                                                  \
+    jeb_op_end(jfs_, (op), ftype_, fd_, (offset), (bytes), ret_);                   \
+    return (ret_);                                                                  \
+} while (0)
+
+/* same for the calls that take a name rather than a handle */
+#define JEB_FS_TIMED(fs, op, ftype, call) do {                                      \
+    JEB_FILE_SYSTEM *jfs_ = (JEB_FILE_SYSTEM *)(fs);                                \
+    int ret_;                                                                       \
+    jeb_op_begin(jfs_);                                                             \
+    ret_ = (call);                                                                  \
+    jeb_op_end(jfs_, (op), (ftype), -1, 0, 0, ret_);                                \
+    return (ret_);                                                                  \
+} while (0)
+
+static int
+jeb_fh_read_timed(WT_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t offset, size_t len, void *buf) {
+    JEB_FH_TIMED(fh, JEB_OP_READ, offset, len, jeb_fh_read(fh, session, offset, len, buf));
+}
+
+static int
+jeb_fh_write_timed(WT_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t offset, size_t len, const void *buf) {
+    JEB_FH_TIMED(fh, JEB_OP_WRITE, offset, len, jeb_fh_write(fh, session, offset, len, buf));
+}
+
+static int
+jeb_fh_sync_timed(WT_FILE_HANDLE *fh, WT_SESSION *session) {
+    JEB_FH_TIMED(fh, JEB_OP_SYNC, 0, 0, jeb_fh_sync(fh, session));
+}
+
+static int
+jeb_fh_sync_nowait_timed(WT_FILE_HANDLE *fh, WT_SESSION *session) {
+    JEB_FH_TIMED(fh, JEB_OP_SYNC, 0, 0, jeb_fh_sync_nowait(fh, session));
+}
+
+static int
+jeb_fh_extend_timed(WT_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t offset) {
+    JEB_FH_TIMED(fh, JEB_OP_FALLOCATE, offset, 0, jeb_fh_extend(fh, session, offset));
+}
+
+static int
+jeb_fh_truncate_timed(WT_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t len) {
+    JEB_FH_TIMED(fh, JEB_OP_TRUNCATE, len, 0, jeb_fh_truncate(fh, session, len));
+}
+
+static int
+jeb_fh_size_timed(WT_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t *sizep) {
+    JEB_FH_TIMED(fh, JEB_OP_STATX, 0, 0, jeb_fh_size(fh, session, sizep));
+}
+
+/* the handle is gone once close returns, JEB_FH_TIMED copies out what it needs first */
+static int
+jeb_fh_close_timed(WT_FILE_HANDLE *fh, WT_SESSION *session) {
+    JEB_FH_TIMED(fh, JEB_OP_CLOSE, 0, 0, jeb_fh_close(fh, session));
+}
+
+static int
+jeb_fs_open_timed(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name,
+    WT_FS_OPEN_FILE_TYPE file_type, uint32_t flags, WT_FILE_HANDLE **file_handlep) {
+    JEB_FILE_SYSTEM *jeb_fs = (JEB_FILE_SYSTEM *)fs;
+    int ret;
+
+    jeb_op_begin(jeb_fs);
+    ret = jeb_fs_open(fs, session, name, file_type, flags, file_handlep);
+    jeb_op_end(jeb_fs, JEB_OP_OPEN, jeb_stat_ftype(file_type),
+      ret == 0 ? ((JEB_FILE_HANDLE *)*file_handlep)->fd : -1, 0, 0, ret);
+    return (ret);
+}
+
+static int
+jeb_fs_exist_timed(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name, bool *existp) {
+    JEB_FS_TIMED(fs, JEB_OP_STATX, JEB_FTYPE_OTHER, jeb_fs_exist(fs, session, name, existp));
+}
+
+static int
+jeb_fs_size_timed(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name, wt_off_t *sizep) {
+    JEB_FS_TIMED(fs, JEB_OP_STATX, JEB_FTYPE_OTHER, jeb_fs_size(fs, session, name, sizep));
+}
+
+static int
+jeb_fs_remove_timed(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name, uint32_t flags) {
+    JEB_FS_TIMED(fs, JEB_OP_REMOVE, JEB_FTYPE_OTHER, jeb_fs_remove(fs, session, name, flags));
+}
+
+static int
+jeb_fs_rename_timed(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *from, const char *to,
+    uint32_t flags) {
+    JEB_FS_TIMED(fs, JEB_OP_RENAME, JEB_FTYPE_OTHER, jeb_fs_rename(fs, session, from, to, flags));
+}
+/* ! [JEB :: STATS] */
+
+/* ! [JEB :: ADMISSION] */
+/* wake the ticket being served on ring (and whoever else shares its futex word) */
+static inline void
+jeb_ring_adm_wake(JEB_RING *ring) {
+    uint32_t *w;
+
+    w = &ring->adm_wait[__atomic_load_n(&ring->adm_serving, __ATOMIC_SEQ_CST) % JEB_ADM_SLOTS];
+    (void)__atomic_add_fetch(w, 1, __ATOMIC_SEQ_CST);
+    jeb_futex_wake_all(w);
+}
+
+/* would n more credits fit in ring's window now */
+static inline bool
+jeb_ring_adm_fits(JEB_RING *ring, uint32_t n) {
+    uint32_t cur;
+
+    cur = __atomic_load_n(&ring->adm_inflight, __ATOMIC_SEQ_CST);
+    return (cur == 0 || cur + n <= __atomic_load_n(&ring->adm_limit, __ATOMIC_RELAXED));
+}
+
+/*
+* take n credits on ring for SQEs about to be submitted there, sleeping until the window
+* has room. called before sq_lock, so a caller that has to wait never holds up the SQ, and
+* the credits come back one per CQE in jeb_cqe_dispatch(). callers get in strictly by
+* ticket, so a large batch isn't starved by a stream of single SQEs; one bigger than the
+* whole window gets in alone once the ring is idle.
+*/
+static void
+jeb_ring_admit(JEB_RING *ring, uint32_t n) {
+    JEB_FILE_SYSTEM *jeb_fs;
+    uint32_t cur, seq, ticket, *w;
+    bool waited;
+
+    jeb_fs = ring->fs;
+    if (!jeb_fs->cfg.admission)
+        return;
+
+    waited = false;
+    ticket = __atomic_fetch_add(&ring->adm_next, 1, __ATOMIC_SEQ_CST);
+    w = &ring->adm_wait[ticket % JEB_ADM_SLOTS];
+    for (;;) {
+        // read the futex word before looking: anything that could let us in bumps it after
+        seq = __atomic_load_n(w, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&ring->adm_serving, __ATOMIC_SEQ_CST) == ticket) {
+            cur = __atomic_load_n(&ring->adm_inflight, __ATOMIC_SEQ_CST);
+            if (cur == 0 || cur + n <= __atomic_load_n(&ring->adm_limit, __ATOMIC_RELAXED)) {
+                // only the ticket being served adds, so this only fails on a completion
+                if (__atomic_compare_exchange_n(&ring->adm_inflight, &cur, cur + n, false,
+                  __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+                    break;
+                continue;
+            }
+            // tell jeb_ring_release() what we're waiting for, then look again: either it
+            // sees our n, or we see the credit it gave back
+            __atomic_store_n(&ring->adm_head_n, n, __ATOMIC_SEQ_CST);
+            if (jeb_ring_adm_fits(ring, n))
+                continue;
+            // the window itself is holding us up, so it may be worth growing
+            __atomic_store_n(&ring->adm_full, true, __ATOMIC_RELAXED);
+        }
+        if (!waited) {
+            waited = true;
+            JEB_STAT_INCR(jeb_fs, adm_waits);
+        }
+        jeb_futex_wait(w, seq);
+    }
+
+    // pass the turn on, waking the next in line if there is one
+    if (__atomic_add_fetch(&ring->adm_serving, 1, __ATOMIC_SEQ_CST) !=
+      __atomic_load_n(&ring->adm_next, __ATOMIC_SEQ_CST))
+        jeb_ring_adm_wake(ring);
+}
+
+/*
+* give back the credit for one reaped CQE, lat_ns after its SQE was admitted. cq_lock is
+* held. reads and writes are sampled: once per window's worth of them the window is
+* adjusted, AIMD style: cut by a quarter if they averaged over target_us (the device is
+* queueing, not working faster), otherwise grown by one if anybody had to wait on it.
+* syncs, fallocates, opens and the like aren't, they take milliseconds however short the
+* queue is.
+*/
+static void
+jeb_ring_release(JEB_RING *ring, bool sample, uint64_t lat_ns) {
+    JEB_FILE_SYSTEM *jeb_fs;
+    uint32_t limit;
+
+    jeb_fs = ring->fs;
+    (void)__atomic_sub_fetch(&ring->adm_inflight, 1, __ATOMIC_SEQ_CST);
+
+    limit = ring->adm_limit;
+    if (sample) {
+        ring->adm_lat_sum += lat_ns;
+        ++ring->adm_lat_n;
+    }
+    if (sample && ring->adm_lat_n >= limit) {
+        if (ring->adm_lat_sum / ring->adm_lat_n > (uint64_t)jeb_fs->cfg.adm_target_us * 1000) {
+            limit -= (limit + 3) / 4;
+            if (limit < jeb_fs->cfg.adm_min_depth)
+                limit = jeb_fs->cfg.adm_min_depth;
+            if (limit != ring->adm_limit)
+                JEB_STAT_INCR(jeb_fs, adm_cuts);
+        } else if (__atomic_load_n(&ring->adm_full, __ATOMIC_RELAXED) &&
+          limit < jeb_fs->cfg.adm_max_depth)
+            ++limit;
+        __atomic_store_n(&ring->adm_limit, limit, __ATOMIC_RELAXED);
+        __atomic_store_n(&ring->adm_full, false, __ATOMIC_RELAXED);
+        ring->adm_lat_n = 0;
+        ring->adm_lat_sum = 0;
+    }
+
+    // only the head can go in, and only once it fits
+    if (__atomic_load_n(&ring->adm_next, __ATOMIC_SEQ_CST) !=
+      __atomic_load_n(&ring->adm_serving, __ATOMIC_SEQ_CST) &&
+      jeb_ring_adm_fits(ring, __atomic_load_n(&ring->adm_head_n, __ATOMIC_SEQ_CST)))
+        jeb_ring_adm_wake(ring);
+}
+/* ! [JEB :: ADMISSION] */
+
+/*
+* hand a CQE's result to whoever is waiting on it. returns true for the shutdown event.
+*/
+static bool
+jeb_cqe_dispatch(JEB_RING *ring, struct io_uring_cqe *cqe) {
+    JEB_DETACHED *d;
+    RING_EVENT_USER_DATA *ud;
+    uintptr_t user_data;
+    uint64_t now;
+
+    user_data = (uintptr_t)io_uring_cqe_get_data(cqe);
+    ud = (RING_EVENT_USER_DATA *)(user_data & ~JEB_UD_TAG_MASK);
+    now = ring->fs->cfg.stats || ring->fs->cfg.admission ? jeb_now_ns() : 0;
+    if (ring->fs->cfg.stats)
+        ud->t_reap = now;
+    if (ring->fs->cfg.admission)
+        jeb_ring_release(ring, (user_data & JEB_UD_TAG_MASK) < ud->rw_tags,
+          now > ud->t_start ? now - ud->t_start : 0);
+    if (ud->class_ring != NULL)
+        jeb_class_exit(ring->fs, ud->class_ring, ud->class_id, 1);
+
+    // read the event type before completing; the waiter may recycle the slot
+    // as soon as it sees UD_DONE.
+    switch (ud->event_type) {
+    case EVENT_TYPE_CHUNKED:
+    case EVENT_TYPE_LINKED:
+        jeb_ud_chunk_complete(ud, (uint32_t)(user_data & JEB_UD_TAG_MASK), cqe->res);
+        return (false);
+    case EVENT_TYPE_ASYNC:
+        jeb_ud_put(ring->fs, ud);
+        return (false);
+    case EVENT_TYPE_DETACHED:
+        d = ud->detached;
+        d->res[user_data & JEB_UD_TAG_MASK] = cqe->res;
+        if (__atomic_sub_fetch(&d->pending, 1, __ATOMIC_ACQ_REL) == 0) {
+            jeb_ud_put(ring->fs, ud);
+            jeb_done_set(&d->done);
+        }
+        return (false);
+    case EVENT_TYPE_SHUTDOWN:
+        // whoever reaps it, ring_consumer is the one that has to notice
+        __atomic_store_n(&ring->must_exit, true, __ATOMIC_RELEASE);
+        jeb_ud_complete(ud, cqe->res);
+        return (true);
+    default:
+        jeb_ud_complete(ud, cqe->res);
+        return (false);
+    }
+}
+
+/*
+* drain every CQE that's ready, completing whichever slots they belong to, and give the
+* entries back to the kernel cqe_batch at a time. cq_lock must be held. returns the count.
+*/
+static uint32_t
+jeb_ring_reap(JEB_RING *ring) {
+    struct io_uring_cqe *cqe;
+    unsigned head, n;
+    uint32_t total = 0;
+
+    do {
+        n = 0;
+        io_uring_for_each_cqe(&ring->ring, head, cqe) {
+            (void)jeb_cqe_dispatch(ring, cqe);
+            if (++n == ring->fs->cfg.cqe_batch)
+                break;
+        }
+        io_uring_cq_advance(&ring->ring, n);
+        total += n;
+    } while (n == ring->fs->cfg.cqe_batch);
+    return (total);
+}
+
+/*
+* wait for ud, reaping the ring ourselves when submitter_reap is on. if the CQ is empty, or
+* another thread is already draining it, fall back to the futex wait: ring_consumer is still
+* woken by the eventfd and will complete whatever nobody else picked up.
+*/
+static int
+jeb_ring_wait(JEB_RING *ring, RING_EVENT_USER_DATA *ud) {
+    uint32_t n;
+    int ret;
+
+    while (ring->fs->cfg.submitter_reap &&
+      __atomic_load_n(&ud->lock_flag, __ATOMIC_ACQUIRE) != UD_DONE) {
+        if (pthread_mutex_trylock(&ring->cq_lock) != 0)
+            break;
+        n = jeb_ring_reap(ring);
+        pthread_mutex_unlock(&ring->cq_lock);
+        if (n == 0)
+            break;
+    }
+    ret = jeb_ud_wait(ud);
+    jeb_op_waited(ud);
+    return (ret);
+}
+
+/*
+* wait on an IOPOLL ring. there's no consumer thread: whoever gets cq_lock polls the device
+* (peeking an IOPOLL ring enters the kernel to poll) and completes whatever it finds, for
+* any waiter, while the rest spin on their slot. nobody sleeps on the futex, there might be
+* nobody left to reap their CQE. io_uring_wait_cqe() is out too: if another waiter already
+* reaped ours it would poll for a completion that isn't coming.
+*/
+static int
+jeb_ring_poll_wait(JEB_RING *ring, RING_EVENT_USER_DATA *ud) {
+    struct io_uring_cqe *cqe;
+    uint32_t idle = 0, n;
+
+    while (__atomic_load_n(&ud->lock_flag, __ATOMIC_ACQUIRE) != UD_DONE) {
+        n = 0;
+        if (pthread_mutex_trylock(&ring->cq_lock) == 0) {
+            if (io_uring_peek_cqe(&ring->ring, &cqe) == 0)
+                n = jeb_ring_reap(ring);
+            pthread_mutex_unlock(&ring->cq_lock);
+        }
+        if (n != 0)
+            idle = 0;
+        else if (++idle < ring->fs->cfg.iopoll_spin)
+            JEB_CPU_RELAX();
+        else {
+            idle = 0;
+            sched_yield();
+        }
+    }
+    jeb_op_waited(ud);
+    return (ud->ret_code);
+}
+
+/*
+* pick the ring this caller should submit to, according to the configured topology.
+*/
+static JEB_RING *
+jeb_ring_select(JEB_FILE_SYSTEM *jeb_fs, WT_SESSION *session) {
+    unsigned int cpu, node;
+    uint64_t h;
+
+    if (jeb_fs->nrings == 1)
+        return (&jeb_fs->rings[0]);
+
+    switch (jeb_fs->cfg.ring_topology) {
+    case RING_TOPOLOGY_NUMA:
+        if (getcpu(&cpu, &node) != 0)
+            node = 0;
+        return (&jeb_fs->rings[node % jeb_fs->nrings]);
+    case RING_TOPOLOGY_SESSION:
+        // sessions are long-lived and owned by one thread at a time, so hashing the handle
+        // keeps a session on the same ring. the NULL session (WT internal calls) lands on ring 0.
+        h = ((uint64_t)(uintptr_t)session >> 4) * 0x9E3779B97F4A7C15ULL;
+        return (&jeb_fs->rings[(h >> 32) % jeb_fs->nrings]);
+    case RING_TOPOLOGY_CPU:
+    default:
+        cpu = (unsigned int)sched_getcpu();
+        return (&jeb_fs->rings[cpu % jeb_fs->nrings]);
+    }
+}
+
+/*
+* next free SQE, with the SQ lock already held. if the SQ is full, push what's there to
+* the kernel (and with SQPOLL, wait for the poller to make room).
+*/
+static struct io_uring_sqe *
+jeb_ring_next_sqe(JEB_RING *ring) {
+    struct io_uring_sqe *sqe;
+
+    while ((sqe = io_uring_get_sqe(&ring->ring)) == NULL) {
+        (void)io_uring_submit(&ring->ring);
+        (void)io_uring_sqring_wait(&ring->ring);
+    }
+    return (sqe);
+}
+
+/*
+* grab an SQE from the ring. this takes the ring's SQ lock, which is held until the
+* SQE is handed to jeb_ring_submit_and_wait(). callers that want a completion slot get
+* it after this, so its start time doesn't include waiting for admission.
+*/
+static struct io_uring_sqe *
+jeb_ring_get_sqe(JEB_RING *ring) {
+    jeb_ring_admit(ring, 1);
+    pthread_mutex_lock(&ring->sq_lock);
+    return (jeb_ring_next_sqe(ring));
+}
+
+/*
+* publish the SQEs prepped under sq_lock and drop the lock. with submit batching on, the
+* first thread to get here becomes the batch leader: it lets go of the SQ for up to
+* batch_window_us, or until batch_entries SQEs are queued, so other sessions can add theirs,
+* then sends the lot with a single io_uring_submit. anyone arriving while a leader is
+* collecting just leaves their SQEs for it, and the one that fills the batch wakes the
+* leader. a full SQ still gets flushed early by jeb_ring_next_sqe().
+*/
+static void
+jeb_ring_submit_unlock(JEB_RING *ring) {
+    JEB_FILE_SYSTEM *jeb_fs;
+    uint64_t deadline, now;
+    uint32_t spins;
+    int n;
+    bool full;
+
+    jeb_fs = ring->fs;
+    if (jeb_fs->cfg.batch_entries == 0) {
+        io_uring_submit(&ring->ring);
+        pthread_mutex_unlock(&ring->sq_lock);
+        jeb_op_submitted();
+        return;
+    }
+    // a follower's SQEs go out with the leader's batch; the time until then counts as service
+    if (ring->batch_leader) {
+        full = io_uring_sq_ready(&ring->ring) >= jeb_fs->cfg.batch_entries &&
+          __atomic_exchange_n(&ring->batch_full, 1, __ATOMIC_SEQ_CST) == 0;
+        pthread_mutex_unlock(&ring->sq_lock);
+        if (full)
+            jeb_futex_wake(&ring->batch_full);
+        jeb_op_submitted();
+        return;
+    }
+
+    ring->batch_leader = true;
+    __atomic_store_n(&ring->batch_full, 0, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&ring->sq_lock);
+
+    // spin briefly in case the batch fills right away, then sleep out the window. the futex
+    // compare catches a follower that fills it just before we go to sleep. io_uring_sq_ready()
+    // is read unlocked here; it only decides when to stop waiting
+    deadline = jeb_now_ns() + (uint64_t)jeb_fs->cfg.batch_window_us * 1000;
+    for (spins = 0; __atomic_load_n(&ring->batch_full, __ATOMIC_SEQ_CST) == 0 &&
+      io_uring_sq_ready(&ring->ring) < jeb_fs->cfg.batch_entries &&
+      (now = jeb_now_ns()) < deadline; spins++) {
+        if (spins < SUBMIT_BATCH_SPIN)
+            JEB_CPU_RELAX();
+        else
+            jeb_futex_wait_timeout(&ring->batch_full, 0, deadline - now);
+    }
+
+    pthread_mutex_lock(&ring->sq_lock);
+    if ((n = io_uring_submit(&ring->ring)) > 0) {
+        JEB_TSTAT_INCR(jeb_fs, submits, 1);
+        JEB_TSTAT_INCR(jeb_fs, submit_sqes, (uint64_t)n);
+    }
+    ring->batch_leader = false;
+    pthread_mutex_unlock(&ring->sq_lock);
+    jeb_op_submitted();
+}
+
+/*
+* attach a completion slot to an already-prepped SQE, submit it, and block until
+* ring_consumer hands back the CQE. returns cqe->res (a negative errno on failure).
+*/
+static int
+jeb_ring_submit_and_wait(JEB_RING *ring, struct io_uring_sqe *sqe, int event_type) {
+    RING_EVENT_USER_DATA *ud;
+    int ret;
+
+    ud = jeb_ud_get(ring->fs, event_type);
+    io_uring_sqe_set_data(sqe, ud);
+    jeb_ring_submit_unlock(ring);
+
+    ret = jeb_ring_wait(ring, ud);
+    jeb_ud_put(ring->fs, ud);
+    return (ret);
+}
+
+/*
+* attach ud to an already-prepped SQE and submit it without waiting. whoever owns ud reaps
+* it later, or ring_consumer recycles it if it's EVENT_TYPE_ASYNC.
+*/
+static void
+jeb_ring_submit_nowait(JEB_RING *ring, struct io_uring_sqe *sqe, RING_EVENT_USER_DATA *ud) {
+    io_uring_sqe_set_data(sqe, ud);
+    jeb_ring_submit_unlock(ring);
+}
+
+static int
+jeb_ud_pool_init(JEB_FILE_SYSTEM *jeb_fs) {
+    int ret;
+
+    if ((jeb_fs->ud_pool = aligned_alloc(
+      JEB_CACHE_LINE, UD_POOL_SIZE * sizeof(RING_EVENT_USER_DATA))) == NULL)
+        return (ENOMEM);
+    memset(jeb_fs->ud_pool, 0, UD_POOL_SIZE * sizeof(RING_EVENT_USER_DATA));
+    for (uint32_t i = 0; i < UD_POOL_SIZE; i++)
+        jeb_fs->ud_pool[i].idx = i;
+
+    if ((ret = jeb_freelist_init(&jeb_fs->ud_free, UD_POOL_SIZE)) != 0) {
+        free(jeb_fs->ud_pool);
+        jeb_fs->ud_pool = NULL;
+    }
+    return (ret);
+}
+
+static void
+jeb_ud_pool_destroy(JEB_FILE_SYSTEM *jeb_fs) {
+    jeb_freelist_destroy(&jeb_fs->ud_free);
+    free(jeb_fs->ud_pool);
+    jeb_fs->ud_pool = NULL;
+}
+/* ! [JEB :: COMPLETION SLOTS] */
+
+/* ! [JEB :: BUFFER POOLS] */
+static int
+jeb_bufpool_init(JEB_BUFPOOL *pool, uint32_t nslots, size_t slot_size) {
+    size_t page;
+    int ret;
+
+    memset(pool, 0, sizeof(JEB_BUFPOOL));
+    if (nslots == 0)
+        return (0);
+
+    // round slots up to the page size so every slot stays aligned (and O_DIRECT friendly)
+    page = (size_t)sysconf(_SC_PAGESIZE);
+    slot_size = (slot_size + page - 1) & ~(page - 1);
+
+    if ((ret = posix_memalign((void **)&pool->base, page, (size_t)nslots * slot_size)) != 0)
+        return (ret);
+    if ((ret = jeb_freelist_init(&pool->free, nslots)) != 0) {
+        free(pool->base);
+        pool->base = NULL;
+        return (ret);
+    }
+    pool->slot_size = slot_size;
+    pool->nslots = nslots;
+    return (0);
+}
+
+static void
+jeb_bufpool_destroy(JEB_BUFPOOL *pool) {
+    if (pool->nslots == 0)
+        return;
+    jeb_freelist_destroy(&pool->free);
+    free(pool->base);
+    memset(pool, 0, sizeof(JEB_BUFPOOL));
+}
+
+/* grab a free slot big enough for len bytes, or NULL if there isn't one; never blocks */
+static char *
+jeb_bufpool_get(JEB_BUFPOOL *pool, size_t len, uint32_t *idxp) {
+    if (len > pool->slot_size || !jeb_freelist_pop(&pool->free, idxp))
+        return (NULL);
+    return (pool->base + (size_t)*idxp * pool->slot_size);
+}
+
+static void
+jeb_bufpool_put(JEB_BUFPOOL *pool, uint32_t idx) {
+    jeb_freelist_push(&pool->free, idx);
+}
+
+/* build the iovec table for a pool and register it with a ring */
+static int
+jeb_bufpool_register(JEB_BUFPOOL *pool, struct io_uring *ring) {
+    struct iovec *iovs;
+    int ret;
+
+    if ((iovs = calloc(pool->nslots, sizeof(struct iovec))) == NULL)
+        return (ENOMEM);
+    for (uint32_t i = 0; i < pool->nslots; i++) {
+        iovs[i].iov_base = pool->base + (size_t)i * pool->slot_size;
+        iovs[i].iov_len = pool->slot_size;
+    }
+    ret = io_uring_register_buffers(ring, iovs, pool->nslots);
+    free(iovs);
+    return (ret < 0 ? -ret : ret);
+}
+/* ! [JEB :: BUFFER POOLS] */
+
+/* ! [JEB :: REGISTERED FILES] */
+/*
+* give a freshly opened handle a registered file slot. nothing is installed yet, that's
+* left to jeb_sqe_fixed_file(): with a ring per CPU, installing in every ring up front would
+* be a syscall per ring (twice that with IOPOLL) on every open and close, for rings most
+* handles never touch. if the table is full (or disabled) the handle keeps using its raw
+* fd, which is always valid for the things io_uring can't do with a fixed file (fcntl locks,
+* ftruncate, statx).
+*/
+static void
+jeb_fh_register_file(JEB_FILE_HANDLE *fh) {
+    JEB_FILE_SYSTEM *jeb_fs;
+    uint32_t idx;
+
+    jeb_fs = fh->fs;
+    fh->fixed_idx = -1;
+    if (jeb_fs->nfile_slots == 0 || !jeb_freelist_pop(&jeb_fs->file_slots, &idx))
+        return;
+    fh->fixed_idx = (int)idx;
+}
+
+/* clear the slot in the rings it got installed in, and give it back */
+static void
+jeb_fh_unregister_file(JEB_FILE_HANDLE *fh) {
+    JEB_FILE_SYSTEM *jeb_fs;
+    JEB_RING *ring;
+    uint64_t mask;
+    int fd = -1;
+
+    if (fh->fixed_idx < 0)
+        return;
+    jeb_fs = fh->fs;
+    for (int set = 0; set < 2; set++)
+        for (mask = fh->fixed_rings[set]; mask != 0; mask &= mask - 1) {
+            ring = &(set ? jeb_fs->poll_rings : jeb_fs->rings)[__builtin_ctzll(mask)];
+            (void)io_uring_register_files_update(&ring->ring, (unsigned)fh->fixed_idx, &fd, 1);
+        }
+    jeb_freelist_push(&jeb_fs->file_slots, (uint32_t)fh->fixed_idx);
+    fh->fixed_idx = -1;
+}
+
+/*
+* point an SQE for ring that was prepped with the handle's raw fd at its registered slot
+* instead, which saves the kernel an fget/fput per op. ring's sq_lock must be held. the
+* first time around on a ring this installs the fd there; if that fails, the handle sticks
+* to its raw fd on that ring.
+*/
+static inline void
+jeb_sqe_fixed_file(JEB_RING *ring, struct io_uring_sqe *sqe, JEB_FILE_HANDLE *fh) {
+    uint64_t bit;
+    int fd, set;
+
+    if (fh->fixed_idx < 0)
+        return;
+    bit = (uint64_t)1 << ring->id;
+    set = ring->iopoll ? 1 : 0;
+    if ((__atomic_load_n(&fh->fixed_tried[set], __ATOMIC_ACQUIRE) & bit) == 0) {
+        fd = fh->fd;
+        if (io_uring_register_files_update(&ring->ring, (unsigned)fh->fixed_idx, &fd, 1) >= 0)
+            (void)__atomic_or_fetch(&fh->fixed_rings[set], bit, __ATOMIC_RELEASE);
+        (void)__atomic_or_fetch(&fh->fixed_tried[set], bit, __ATOMIC_RELEASE);
+    }
+    if ((__atomic_load_n(&fh->fixed_rings[set], __ATOMIC_ACQUIRE) & bit) == 0)
+        return;
+    sqe->fd = fh->fixed_idx;
+    sqe->flags |= IOSQE_FIXED_FILE;
+}
+/* ! [JEB :: REGISTERED FILES] */
+
+/* ! [JEB :: I/O CLASSES] */
+/* which I/O class a read or write on fh belongs to */
+static inline int
+jeb_io_class(JEB_FILE_HANDLE *fh, WT_SESSION *session, bool is_write) {
+    if (fh->log_file)
+        return (JEB_CLASS_LOG);
+    return (!is_write && session != NULL ? JEB_CLASS_READ : JEB_CLASS_BACKGROUND);
+}
+
+static inline void
+jeb_sqe_ioprio(JEB_FILE_SYSTEM *jeb_fs, struct io_uring_sqe *sqe, int cls) {
+    if (jeb_fs->cfg.io_classes && jeb_fs->cfg.class_ioprio[cls] >= 0)
+        sqe->ioprio = JEB_IOPRIO_BE(jeb_fs->cfg.class_ioprio[cls]);
+}
+
+/*
+* take n of the class's in-flight budget on ring, sleeping until that much is free. callers
+* never ask for more than the whole budget (see jeb_fh_rw()), or they would sleep forever.
+* waiters aren't queued in order; whoever sees the room first gets it.
+*/
+static void
+jeb_class_enter(JEB_FILE_SYSTEM *jeb_fs, JEB_RING *ring, int cls, uint32_t n) {
+    uint32_t budget, cur;
+    bool waited;
+
+    if ((budget = jeb_fs->cfg.class_depth[cls]) == 0)
+        return;
+
+    waited = false;
+    cur = __atomic_load_n(&ring->class_inflight[cls], __ATOMIC_SEQ_CST);
+    for (;;) {
+        if (cur + n <= budget) {
+            if (__atomic_compare_exchange_n(&ring->class_inflight[cls], &cur, cur + n, false,
+              __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+                break;
+            continue;
+        }
+        // announce ourselves before sleeping, so jeb_class_exit() knows to wake us; the
+        // futex compare catches an exit that slipped in between
+        if (!waited) {
+            waited = true;
+            (void)__atomic_add_fetch(&ring->class_waiters[cls], 1, __ATOMIC_SEQ_CST);
+            JEB_STAT_INCR(jeb_fs, class_waits);
+        } else
+            jeb_futex_wait(&ring->class_inflight[cls], cur);
+        cur = __atomic_load_n(&ring->class_inflight[cls], __ATOMIC_SEQ_CST);
+    }
+    if (waited)
+        (void)__atomic_sub_fetch(&ring->class_waiters[cls], 1, __ATOMIC_SEQ_CST);
+}
+
+/* give back what jeb_class_enter() took, and let any waiters have a look */
+static void
+jeb_class_exit(JEB_FILE_SYSTEM *jeb_fs, JEB_RING *ring, int cls, uint32_t n) {
+    if (jeb_fs->cfg.class_depth[cls] == 0)
+        return;
+
+    (void)__atomic_sub_fetch(&ring->class_inflight[cls], n, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->class_waiters[cls], __ATOMIC_SEQ_CST) != 0)
+        jeb_futex_wake_all(&ring->class_inflight[cls]);
+}
+
+/*
+* for ops nobody waits on (readahead, write-combine, extend, sync_nowait): the caller took
+* one of cls's budget on ring per SQE before submitting, and the dispatch of each CQE gives
+* it back. not the handle's own reap of the slot, that can be a long time coming (a window
+* nobody reads, a flush until the next sync) and the budget would leak away meanwhile.
+*/
+static inline void
+jeb_ud_class(RING_EVENT_USER_DATA *ud, JEB_RING *ring, int cls) {
+    ud->class_ring = ring;
+    ud->class_id = cls;
+}
+/* ! [JEB :: I/O CLASSES] */
+
+/* ! [JEB :: I/O BUFFERS] */
+/*
+* Where the kernel actually reads into or writes from for one request: WiredTiger's own buffer,
+* a registered buffer slot, or an aligned bounce buffer for an O_DIRECT handle. fd is the
+* descriptor to use, which for O_DIRECT handles depends on the request's alignment.
+*/
+typedef struct __jeb_io_buf {
+    char *buf;
+    int regbuf_idx;     // >= 0 if buf is a registered slot (READ_FIXED/WRITE_FIXED)
+    int bounce_idx;     // >= 0 if buf is a bounce pool slot
+    bool bounce_alloc;  // buf is a one-off aligned allocation
+    int fd;
+} JEB_IO_BUF;
+
+/* ask the kernel what alignment O_DIRECT needs on this file */
+static void
+jeb_fh_dio_align(JEB_FILE_HANDLE *fh) {
+    fh->dio_mem_align = DIO_DEFAULT_ALIGN;
+    fh->dio_offset_align = DIO_DEFAULT_ALIGN;
+#ifdef STATX_DIOALIGN
+    struct statx stx;
+    if (statx(fh->fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &stx) == 0 &&
+      (stx.stx_mask & STATX_DIOALIGN) && stx.stx_dio_mem_align != 0 && stx.stx_dio_offset_align != 0) {
+        fh->dio_mem_align = stx.stx_dio_mem_align;
+        fh->dio_offset_align = stx.stx_dio_offset_align;
+    }
+#endif
+}
+
+/*
+* the buffered twin of an O_DIRECT handle. Linux keeps the two coherent: direct reads
+* flush dirty page cache over their range first, and direct writes invalidate it.
+*/
+static int
+jeb_fh_buffered_fd(JEB_FILE_HANDLE *fh, int *fdp) {
+    int expected, fd;
+
+    if ((fd = __atomic_load_n(&fh->buffered_fd, __ATOMIC_ACQUIRE)) >= 0) {
+        *fdp = fd;
+        return (0);
+    }
+
+    if ((fd = open(fh->iface.name, fh->open_flags & ~(O_DIRECT | O_CREAT | O_EXCL | O_TRUNC))) < 0)
+        return (errno);
+
+    // racing openers: first one wins, the rest close theirs
+    expected = -1;
+    if (!__atomic_compare_exchange_n(
+      &fh->buffered_fd, &expected, fd, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        (void)close(fd);
+        fd = expected;
+    }
+    *fdp = fd;
+    return (0);
+}
+
+/*
+* pick the buffer and fd for a read or write of len bytes at offset. for writes the caller's
+* data is copied into whatever staging buffer gets picked.
+*/
+static int
+jeb_io_buf_get(JEB_FILE_HANDLE *fh, const void *user_buf, size_t len, wt_off_t offset,
+    bool is_write, JEB_IO_BUF *iob) {
+    JEB_FILE_SYSTEM *jeb_fs;
+    uint32_t idx;
+    int ret;
+
+    jeb_fs = fh->fs;
+    iob->buf = (char *)user_buf;
+    iob->regbuf_idx = -1;
+    iob->bounce_idx = -1;
+    iob->bounce_alloc = false;
+    iob->fd = fh->fd;
+
+    if (fh->direct_io &&
+      (!JEB_ALIGNED(offset, fh->dio_offset_align) || !JEB_ALIGNED(len, fh->dio_offset_align))) {
+        // O_DIRECT can't do this one at all; send it through the page cache
+        if ((ret = jeb_fh_buffered_fd(fh, &iob->fd)) != 0)
+            return (ret);
+        JEB_TSTAT_INCR(jeb_fs, dio_unaligned, 1);
+    }
+
+    // a registered slot when one fits, so the kernel doesn't have to pin/unpin WT's pages.
+    // slots are page aligned, so that covers O_DIRECT too.
+    if ((iob->buf = jeb_bufpool_get(&jeb_fs->regbufs, len, &idx)) != NULL)
+        iob->regbuf_idx = (int)idx;
+    else if (iob->fd == fh->fd && fh->direct_io && !JEB_ALIGNED(user_buf, fh->dio_mem_align)) {
+        if ((iob->buf = jeb_bufpool_get(&jeb_fs->bounce, len, &idx)) != NULL)
+            iob->bounce_idx = (int)idx;
+        else {
+            if ((ret = posix_memalign((void **)&iob->buf, fh->dio_mem_align, len)) != 0)
+                return (ret);
+            iob->bounce_alloc = true;
+        }
+        JEB_TSTAT_INCR(jeb_fs, dio_bounced, 1);
+    } else
+        iob->buf = (char *)user_buf;
+
+    if (is_write && iob->buf != user_buf)
+        memcpy(iob->buf, user_buf, len);
+    return (0);
+}
+
+static void
+jeb_io_buf_put(JEB_FILE_HANDLE *fh, JEB_IO_BUF *iob) {
+    if (iob->regbuf_idx >= 0)
+        jeb_bufpool_put(&fh->fs->regbufs, (uint32_t)iob->regbuf_idx);
+    else if (iob->bounce_idx >= 0)
+        jeb_bufpool_put(&fh->fs->bounce, (uint32_t)iob->bounce_idx);
+    else if (iob->bounce_alloc)
+        free(iob->buf);
+}
+
+/* prep a read or write SQE against the buffer and fd chosen by jeb_io_buf_get() */
+static void
+jeb_prep_rw(JEB_RING *ring, struct io_uring_sqe *sqe, JEB_FILE_HANDLE *fh, JEB_IO_BUF *iob,
+    size_t len, wt_off_t offset, bool is_write) {
+    if (iob->regbuf_idx >= 0) {
+        if (is_write)
+            io_uring_prep_write_fixed(sqe, iob->fd, iob->buf, len, offset, iob->regbuf_idx);
+        else
+            io_uring_prep_read_fixed(sqe, iob->fd, iob->buf, len, offset, iob->regbuf_idx);
+    } else if (is_write)
+        io_uring_prep_write(sqe, iob->fd, iob->buf, len, offset);
+    else
+        io_uring_prep_read(sqe, iob->fd, iob->buf, len, offset);
+
+    // only the primary fd is in the registered file table
+    if (iob->fd == fh->fd)
+        jeb_sqe_fixed_file(ring, sqe, fh);
+}
+
+typedef struct __jeb_io_chunk {
+    size_t off;  // from the start of the request
+    size_t len;  // bytes of this chunk still to transfer
+} JEB_IO_CHUNK;
+
+/*
+* read or write len bytes at offset. the request is cut into chunk_size pieces that go to the
+* ring as one batch, so the device can work on them in parallel, and the caller waits once per
+* batch. a short transfer leaves the rest of its chunk outstanding for the next batch; a
+* zero-length one is an error (EOF on read).
+*/
+static int
+jeb_fh_rw(JEB_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t offset, size_t len, char *buf,
+    bool is_write) {
+    JEB_IO_CHUNK chunks[JEB_CHUNK_MAX];
+    JEB_IO_BUF iobs[JEB_CHUNK_MAX];
+    int res[JEB_CHUNK_MAX];
+    JEB_FILE_SYSTEM *jeb_fs;
+    JEB_RING *ring, *r;
+    RING_EVENT_USER_DATA *ud;
+    struct io_uring_sqe *sqe;
+    size_t chunk_size, next;
+    uint32_t i, live, max_chunks, n;
+    int cls, ret = 0;
+    bool poll;
+
+    jeb_fs = fh->fs;
+    chunk_size = jeb_fs->cfg.chunk_size != 0 ? jeb_fs->cfg.chunk_size : JEB_CHUNK_LIMIT;
+    max_chunks = jeb_fs->cfg.queue_depth < JEB_CHUNK_MAX ? jeb_fs->cfg.queue_depth : JEB_CHUNK_MAX;
+    ring = jeb_ring_select(jeb_fs, session);
+
+    // a batch can't be bigger than its class's whole budget
+    cls = jeb_io_class(fh, session, is_write);
+    if (jeb_fs->cfg.class_depth[cls] != 0 && jeb_fs->cfg.class_depth[cls] < max_chunks)
+        max_chunks = jeb_fs->cfg.class_depth[cls];
+
+    // next is where the part of buf not yet handed to a chunk starts
+    for (n = 0, next = 0; n > 0 || next < len; n = live) {
+        // top up the batch with fresh chunks behind any short ones carried over
+        for (; n < max_chunks && next < len; ++n) {
+            chunks[n].off = next;
+            chunks[n].len = len - next < chunk_size ? len - next : chunk_size;
+            next += chunks[n].len;
+        }
+
+        // the budget is counted against the ring the caller picked, even if the batch
+        // ends up on its IOPOLL twin
+        jeb_class_enter(jeb_fs, ring, cls, n);
+        for (i = 0; i < n; i++)
+            if ((ret = jeb_io_buf_get(fh, buf + chunks[i].off, chunks[i].len,
+              offset + (wt_off_t)chunks[i].off, is_write, &iobs[i])) != 0) {
+                while (i > 0)
+                    jeb_io_buf_put(fh, &iobs[--i]);
+                jeb_class_exit(jeb_fs, ring, cls, n);
+                return (ret);
+            }
+
+        // O_DIRECT batches go to the IOPOLL ring, unless a chunk had to take the buffered fd
+        poll = jeb_fs->poll_rings != NULL && fh->direct_io &&
+          !__atomic_load_n(&fh->no_iopoll, __ATOMIC_RELAXED);
+        for (i = 0; i < n && poll; i++)
+            if (iobs[i].fd != fh->fd)
+                poll = false;
+        r = poll ? &jeb_fs->poll_rings[ring->id] : ring;
+
+        jeb_ring_admit(r, n);
+        ud = jeb_ud_get(jeb_fs, EVENT_TYPE_CHUNKED);
+        ud->pending = n;
+        ud->rw_tags = n;
+        ud->chunk_res = res;
+
+        pthread_mutex_lock(&r->sq_lock);
+        for (i = 0; i < n; i++) {
+            sqe = jeb_ring_next_sqe(r);
+            jeb_prep_rw(r, sqe, fh, &iobs[i], chunks[i].len, offset + (wt_off_t)chunks[i].off, is_write);
+            jeb_sqe_ioprio(jeb_fs, sqe, cls);
+            io_uring_sqe_set_data(sqe, (void *)((uintptr_t)ud | i));
+        }
+        jeb_ring_submit_unlock(r);
+
+        if (poll)
+            (void)jeb_ring_poll_wait(r, ud);
+        else
+            (void)jeb_ring_wait(r, ud);
+        jeb_ud_put(jeb_fs, ud);
+        jeb_class_exit(jeb_fs, ring, cls, n);
+
+        // collect the results, compacting short chunks to the front for the next round
+        for (i = 0, live = 0; i < n; i++) {
+            if (res[i] > 0 && !is_write && iobs[i].buf != buf + chunks[i].off)
+                memcpy(buf + chunks[i].off, iobs[i].buf, (size_t)res[i]);
+            jeb_io_buf_put(fh, &iobs[i]);
+
+            // not everything under O_DIRECT can be polled; resend the chunk the usual way
+            if (poll && res[i] == -EOPNOTSUPP) {
+                __atomic_store_n(&fh->no_iopoll, true, __ATOMIC_RELAXED);
+                chunks[live++] = chunks[i];
+            } else if (res[i] <= 0) {
+                if (ret == 0)
+                    ret = res[i] < 0 ? -res[i] : (is_write ? EIO : WT_ERROR);
+            } else if ((size_t)res[i] < chunks[i].len) {
+                chunks[live].off = chunks[i].off + (size_t)res[i];
+                chunks[live].len = chunks[i].len - (size_t)res[i];
+                ++live;
+            }
+        }
+        if (ret != 0)
+            return (ret);
+    }
+    return (0);
+}
+/* ! [JEB :: I/O BUFFERS] */
+
+/* ! [JEB :: GROUP COMMIT] */
+/* fdatasync through the ring, for when a commit chain didn't make it all the way */
+static int
+jeb_fh_datasync(JEB_FILE_HANDLE *fh, WT_SESSION *session) {
+    JEB_RING *ring;
+    struct io_uring_sqe *sqe;
+    int ret;
+
+    ring = jeb_ring_select(fh->fs, session);
+    sqe = jeb_ring_get_sqe(ring);
+    io_uring_prep_fsync(sqe, fh->fd, IORING_FSYNC_DATASYNC);
+    jeb_sqe_fixed_file(ring, sqe, fh);
+    ret = jeb_ring_submit_and_wait(ring, sqe, EVENT_TYPE_NORMAL);
+    return (ret < 0 ? -ret : 0);
+}
+
+/*
+* commit a leader's batch: each run of writes goes out as one IOSQE_IO_LINK chain with an
+* fdatasync at the tail, and every write in the run gets the chain's result. if anything in
+* the chain comes back short or broken, the rest of the kernel's chain is cancelled; those
+* writes are finished synchronously and followed by a separate fdatasync.
+*/
+static void
+jeb_commit_batch(JEB_FILE_HANDLE *fh, WT_SESSION *session, JEB_COMMIT_REQ *batch) {
+    JEB_COMMIT_REQ *reqs[JEB_CHUNK_MAX];
+    JEB_IO_BUF iobs[JEB_CHUNK_MAX];
+    int errs[JEB_CHUNK_MAX], res[JEB_CHUNK_MAX];
+    JEB_FILE_SYSTEM *jeb_fs;
+    JEB_RING *ring;
+    RING_EVENT_USER_DATA *ud;
+    struct io_uring_sqe *sqe;
+    uint32_t budget, i, max_writes, n, nclass, nsqes;
+    int sync_ret;
+    bool redo;
+
+    jeb_fs = fh->fs;
+    max_writes = (jeb_fs->cfg.queue_depth < JEB_CHUNK_MAX ? jeb_fs->cfg.queue_depth : JEB_CHUNK_MAX) - 1;
+    ring = jeb_ring_select(jeb_fs, session);
+
+    // a chain, fdatasync included, can't be bigger than the log class's whole budget
+    budget = jeb_fs->cfg.class_depth[JEB_CLASS_LOG];
+    if (budget != 0 && budget - 1 < max_writes)
+        max_writes = budget > 1 ? budget - 1 : 1;
+
+    while (batch != NULL) {
+        // the followers' reqs vanish once completed, so collect the run up front
+        for (n = 0; batch != NULL && n < max_writes; batch = batch->next)
+            reqs[n++] = batch;
+
+        for (i = 0, nsqes = 1; i < n; i++)
+            if ((errs[i] = jeb_io_buf_get(fh, reqs[i]->buf, reqs[i]->len, reqs[i]->offset,
+              true, &iobs[i])) == 0)
+                ++nsqes;
+
+        // with log_depth=1 a write and its fdatasync still have to go out together
+        nclass = budget != 0 && nsqes > budget ? budget : nsqes;
+        jeb_class_enter(jeb_fs, ring, JEB_CLASS_LOG, nclass);
+        jeb_ring_admit(ring, nsqes);
+        ud = jeb_ud_get(jeb_fs, EVENT_TYPE_LINKED);
+        ud->pending = nsqes;
+        ud->rw_tags = n;         // the writes; the fdatasync is tagged n
+        ud->chunk_res = res;
+
+        pthread_mutex_lock(&ring->sq_lock);
+        // the chain has to reach the kernel in one piece, else the fsync could start early
+        while (io_uring_sq_space_left(&ring->ring) < nsqes) {
+            (void)io_uring_submit(&ring->ring);
+            (void)io_uring_sqring_wait(&ring->ring);
+        }
+        for (i = 0; i < n; i++) {
+            if (errs[i] != 0)
+                continue;
+            sqe = jeb_ring_next_sqe(ring);
+            jeb_prep_rw(ring, sqe, fh, &iobs[i], reqs[i]->len, reqs[i]->offset, true);
+            jeb_sqe_ioprio(jeb_fs, sqe, JEB_CLASS_LOG);
+            sqe->flags |= IOSQE_IO_LINK;
+            io_uring_sqe_set_data(sqe, (void *)((uintptr_t)ud | i));
+        }
+        sqe = jeb_ring_next_sqe(ring);
+        io_uring_prep_fsync(sqe, fh->fd, IORING_FSYNC_DATASYNC);
+        jeb_sqe_fixed_file(ring, sqe, fh);
+        jeb_sqe_ioprio(jeb_fs, sqe, JEB_CLASS_LOG);
+        io_uring_sqe_set_data(sqe, (void *)((uintptr_t)ud | n));
+        // the commit leader has already batched its followers, don't make them wait again
+        io_uring_submit(&ring->ring);
+        pthread_mutex_unlock(&ring->sq_lock);
+        jeb_op_submitted();
+
+        (void)jeb_ring_wait(ring, ud);
+        jeb_ud_put(jeb_fs, ud);
+        jeb_class_exit(jeb_fs, ring, JEB_CLASS_LOG, nclass);
+
+        sync_ret = res[n] < 0 ? -res[n] : 0;
+        redo = false;
+        for (i = 0; i < n; i++) {
+            if (errs[i] != 0)
+                continue;
+            jeb_io_buf_put(fh, &iobs[i]);
+            if (res[i] >= 0 && (size_t)res[i] == reqs[i]->len)
+                continue;
+
+            // short writes, and the writes cancelled behind them, get finished here
+            if (res[i] >= 0 || res[i] == -ECANCELED) {
+                redo = true;
+                if (res[i] < 0)
+                    res[i] = 0;
+                errs[i] = jeb_fh_rw(fh, session, reqs[i]->offset + res[i],
+                  reqs[i]->len - (size_t)res[i], (char *)reqs[i]->buf + res[i], true);
+            } else
+                errs[i] = -res[i];
+        }
+        // a failed write cancels the tail fsync too, and the writes ahead of it still need one
+        if (redo || res[n] == -ECANCELED)
+            sync_ret = jeb_fh_datasync(fh, session);
+
+        for (i = 0; i < n; i++)
+            jeb_ud_complete(reqs[i]->ud, errs[i] != 0 ? errs[i] : sync_ret);
+    }
+}
+
+/*
+* write to a durable log file. committers queue their writes on the handle; whoever finds no
+* leader becomes it, commits everything queued as one batch, then hands leadership to the
+* oldest committer that queued up meanwhile. everyone else just sleeps until their write
+* (and the fdatasync behind it) is done.
+*/
+static int
+jeb_fh_commit_write(JEB_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t offset, size_t len,
+    const void *buf) {
+    JEB_COMMIT_REQ req, *batch;
+    int ret;
+
+    req.next = NULL;
+    req.buf = buf;
+    req.len = len;
+    req.offset = offset;
+    req.ud = jeb_ud_get(fh->fs, EVENT_TYPE_NORMAL);
+
+    pthread_mutex_lock(&fh->commit_lock);
+    *fh->commit_tailp = &req;
+    fh->commit_tailp = &req.next;
+    if (fh->commit_leader) {
+        pthread_mutex_unlock(&fh->commit_lock);
+        if ((ret = jeb_ud_wait(req.ud)) != JEB_COMMIT_PROMOTED) {
+            jeb_ud_put(fh->fs, req.ud);
+            return (ret);
+        }
+        // the old leader handed over with our write still at the head of the queue
+        __atomic_store_n(&req.ud->lock_flag, UD_PENDING, __ATOMIC_RELAXED);
+        pthread_mutex_lock(&fh->commit_lock);
+    } else
+        fh->commit_leader = true;
+
+    batch = fh->commit_head;
+    fh->commit_head = NULL;
+    fh->commit_tailp = &fh->commit_head;
+    pthread_mutex_unlock(&fh->commit_lock);
+
+    jeb_commit_batch(fh, session, batch);
+
+    pthread_mutex_lock(&fh->commit_lock);
+    if (fh->commit_head != NULL)
+        jeb_ud_complete(fh->commit_head->ud, JEB_COMMIT_PROMOTED);
+    else
+        fh->commit_leader = false;
+    pthread_mutex_unlock(&fh->commit_lock);
+
+    ret = jeb_ud_wait(req.ud);
+    jeb_ud_put(fh->fs, req.ud);
+    return (ret);
+}
+/* ! [JEB :: GROUP COMMIT] */
+
+/* ! [JEB :: DIRECTORIES] */
+/*
+* reserve n SQEs in one go, for a chain that has to reach the kernel in a single submit.
+* takes the SQ lock, which jeb_ring_submit_chain_and_wait() drops.
+*/
+static void
+jeb_ring_get_sqes(JEB_RING *ring, struct io_uring_sqe **sqes, uint32_t n) {
+    jeb_ring_admit(ring, n);
+    pthread_mutex_lock(&ring->sq_lock);
+    while (io_uring_sq_space_left(&ring->ring) < n) {
+        (void)io_uring_submit(&ring->ring);
+        (void)io_uring_sqring_wait(&ring->ring);
+    }
+    for (uint32_t i = 0; i < n; i++)
+        sqes[i] = io_uring_get_sqe(&ring->ring);
+}
+
+/*
+* link the n prepped SQEs from jeb_ring_get_sqes() into one IOSQE_IO_LINK chain, submit it
+* and wait for all of it. each SQE's cqe->res lands in res[].
+*/
+static void
+jeb_ring_submit_chain_and_wait(JEB_RING *ring, struct io_uring_sqe **sqes, uint32_t n, int *res) {
+    RING_EVENT_USER_DATA *ud;
+
+    ud = jeb_ud_get(ring->fs, EVENT_TYPE_LINKED);
+    ud->pending = n;
+    ud->chunk_res = res;
+    for (uint32_t i = 0; i < n; i++) {
+        if (i + 1 < n)
+            sqes[i]->flags |= IOSQE_IO_LINK;
+        io_uring_sqe_set_data(sqes[i], (void *)((uintptr_t)ud | i));
+    }
+    jeb_ring_submit_unlock(ring);
+
+    (void)jeb_ring_wait(ring, ud);
+    jeb_ud_put(ring->fs, ud);
+}
+
+/*
+* split path into its parent directory (copied into dir) and the last component. returns
+* ENAMETOOLONG if the directory doesn't fit.
+*/
+static int
+jeb_path_split(const char *path, char *dir, size_t dirsz, const char **basep) {
+    const char *slash;
+    size_t len;
+
+    if ((slash = strrchr(path, '/')) == NULL) {
+        (void)strcpy(dir, ".");
+        *basep = path;
+        return (0);
+    }
+    len = slash == path ? 1 : (size_t)(slash - path);
+    if (len >= dirsz)
+        return (ENAMETOOLONG);
+    memcpy(dir, path, len);
+    dir[len] = '\0';
+    *basep = slash + 1;
+    return (0);
+}
+
+/*
+* an fd for directory dir. the first JEB_DIRFD_CACHE directories stay open for the life of
+* the file system; past that *cachedp comes back false and the caller closes the fd.
+* returns the fd, or a negative errno.
+*/
+static int
+jeb_dirfd_get(JEB_FILE_SYSTEM *jeb_fs, const char *dir, bool *cachedp) {
+    char *path;
+    int fd;
+
+    pthread_mutex_lock(&jeb_fs->dirfd_lock);
+    for (uint32_t i = 0; i < jeb_fs->ndirfds; i++)
+        if (strcmp(jeb_fs->dirfds[i].path, dir) == 0) {
+            fd = jeb_fs->dirfds[i].fd;
+            pthread_mutex_unlock(&jeb_fs->dirfd_lock);
+            *cachedp = true;
+            return (fd);
+        }
+
+    *cachedp = false;
+    if ((fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0) {
+        fd = -errno;
+    } else if (jeb_fs->ndirfds < JEB_DIRFD_CACHE && (path = strdup(dir)) != NULL) {
+        jeb_fs->dirfds[jeb_fs->ndirfds].path = path;
+        jeb_fs->dirfds[jeb_fs->ndirfds].fd = fd;
+        ++jeb_fs->ndirfds;
+        *cachedp = true;
+    }
+    pthread_mutex_unlock(&jeb_fs->dirfd_lock);
+    return (fd);
+}
+/* ! [JEB :: DIRECTORIES] */
+
+/* ! [JEB :: READAHEAD] */
+/* fire-and-forget posix_fadvise() through the ring */
+static void
+jeb_fh_fadvise_nowait(JEB_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t offset, wt_off_t len,
+    int advice) {
+    JEB_RING *ring;
+    RING_EVENT_USER_DATA *ud;
+    struct io_uring_sqe *sqe;
+
+    // the SQE only has 32 bits of length; zero means "to the end of the file"
+    if (len > UINT32_MAX)
+        len = 0;
+
+    ring = jeb_ring_select(fh->fs, session);
+    sqe = jeb_ring_get_sqe(ring);
+    ud = jeb_ud_get(fh->fs, EVENT_TYPE_ASYNC);
+    io_uring_prep_fadvise(sqe, fh->fd, (uint64_t)offset, (uint32_t)len, advice);
+    jeb_sqe_fixed_file(ring, sqe, fh);
+    jeb_ring_submit_nowait(ring, sqe, ud);
+}
+
+/* wait for a window's read if it has one in flight. ra_lock must be held (or the handle dead) */
+static void
+jeb_ra_reap(JEB_RA_WINDOW *w) {
+    if (jeb_detached_reap(&w->io))
+        w->len = w->io.res[0] > 0 ? (size_t)w->io.res[0] : 0;
+}
+
+/* start an async read of a window's worth of the file at off into w. ra_lock must be held */
+static void
+jeb_ra_issue(JEB_FILE_HANDLE *fh, WT_SESSION *session, JEB_RA_WINDOW *w, wt_off_t off) {
+    JEB_FILE_SYSTEM *jeb_fs;
+    JEB_RING *ring;
+    RING_EVENT_USER_DATA *ud;
+    struct io_uring_sqe *sqe;
+
+    jeb_fs = fh->fs;
+    // windows are allocated on first use so random-access files never pay for them; aligned
+    // for the sake of O_DIRECT handles
+    if (w->buf == NULL &&
+      posix_memalign((void **)&w->buf, fh->direct_io ? fh->dio_mem_align : DIO_DEFAULT_ALIGN,
+      jeb_fs->cfg.readahead) != 0) {
+        w->buf = NULL;
+        return;
+    }
+
+    w->off = off;
+    w->len = 0;
+    ring = jeb_ring_select(jeb_fs, session);
+    jeb_class_enter(jeb_fs, ring, JEB_CLASS_READ, 1);
+    sqe = jeb_ring_get_sqe(ring);
+    ud = jeb_ud_get_detached(jeb_fs, &w->io, 1);
+    ud->rw_tags = 1;
+    jeb_ud_class(ud, ring, JEB_CLASS_READ);
+    io_uring_prep_read(sqe, fh->fd, w->buf, (uint32_t)jeb_fs->cfg.readahead, off);
+    jeb_sqe_fixed_file(ring, sqe, fh);
+    jeb_sqe_ioprio(jeb_fs, sqe, JEB_CLASS_READ);
+    jeb_ring_submit_nowait(ring, sqe, ud);
+    JEB_TSTAT_INCR(jeb_fs, ra_issued, 1);
+}
+
+/*
+* serve a read from the readahead windows if one covers it, and keep windows going ahead of
+* a sequential reader. a read that lands in a window still in flight waits for it, that read
+* started before this one could have. returns true if buf was filled.
+*/
+static bool
+jeb_ra_read(JEB_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t offset, size_t len, char *buf) {
+    JEB_RA_WINDOW *w;
+    wt_off_t ahead, align, end, size, w_end;
+    bool eof, hit;
+
+    size = (wt_off_t)fh->fs->cfg.readahead;
+    end = offset + (wt_off_t)len;
+    hit = eof = false;
+
+    pthread_mutex_lock(&fh->ra_lock);
+    for (int i = 0; i < JEB_RA_WINDOWS; i++) {
+        w = &fh->ra[i];
+        if ((w->io.busy || w->len != 0) && offset >= w->off && end <= w->off + size) {
+            jeb_ra_reap(w);
+            if (end <= w->off + (wt_off_t)w->len) {
+                memcpy(buf, w->buf + (offset - w->off), len);
+                hit = true;
+            }
+            break;
+        }
+    }
+
+    fh->ra_streak = offset == fh->ra_next ? fh->ra_streak + 1 : 0;
+    fh->ra_next = end;
+
+    if (fh->ra_streak >= JEB_RA_TRIGGER) {
+        // the next window goes after whatever is already buffered or on its way past the cursor
+        ahead = end;
+        for (int i = 0; i < JEB_RA_WINDOWS; i++) {
+            w = &fh->ra[i];
+            w_end = w->off + (w->io.busy ? size : (wt_off_t)w->len);
+            if ((w->io.busy || w->len != 0) && w_end > ahead)
+                ahead = w_end;
+            // a short window means it ran into the end of the file
+            if (!w->io.busy && w->len != 0 && (wt_off_t)w->len < size && w_end >= end)
+                eof = true;
+        }
+        align = fh->direct_io ? (wt_off_t)fh->dio_offset_align : DIO_DEFAULT_ALIGN;
+        ahead &= ~(align - 1);
+
+        // refill any window the reader is done with
+        for (int i = 0; i < JEB_RA_WINDOWS && !eof; i++) {
+            w = &fh->ra[i];
+            if (!w->io.busy && w->off + (wt_off_t)w->len <= end) {
+                jeb_ra_issue(fh, session, w, ahead);
+                ahead += size;
+            }
+        }
+    }
+    pthread_mutex_unlock(&fh->ra_lock);
+
+    if (hit)
+        JEB_TSTAT_INCR(fh->fs, ra_hits, 1);
+    return (hit);
+}
+
+/*
+* drop any window overlapping [offset, end) once a write or truncate has changed it, end of
+* -1 meaning to the end of the file. windows still in flight are waited for, they may hold
+* data from before the change.
+*/
+static void
+jeb_ra_invalidate(JEB_FILE_HANDLE *fh, wt_off_t offset, wt_off_t end) {
+    JEB_RA_WINDOW *w;
+    wt_off_t size;
+
+    size = (wt_off_t)fh->fs->cfg.readahead;
+    pthread_mutex_lock(&fh->ra_lock);
+    for (int i = 0; i < JEB_RA_WINDOWS; i++) {
+        w = &fh->ra[i];
+        if ((w->io.busy || w->len != 0) && w->off + size > offset && (end < 0 || w->off < end)) {
+            jeb_ra_reap(w);
+            w->len = 0;
+        }
+    }
+    pthread_mutex_unlock(&fh->ra_lock);
+}
+/* ! [JEB :: READAHEAD] */
+
+/* ! [JEB :: BLOCK CACHE] */
+static inline uint64_t
+jeb_bc_hash(uint64_t file_id, uint64_t granule) {
+    return ((file_id * 0x9E3779B97F4A7C15ULL) ^ (granule * 0xC2B2AE3D27D4EB4FULL));
+}
+
+/* the shard, and bucket within it, for a file's granule */
+static JEB_BC_SHARD *
+jeb_bc_locate(JEB_FILE_SYSTEM *jeb_fs, uint64_t file_id, uint64_t granule, JEB_BC_ENTRY ***bucketp) {
+    JEB_BC_SHARD *shard;
+    uint64_t h;
+
+    h = jeb_bc_hash(file_id, granule);
+    shard = &jeb_fs->bcache[(h >> 48) % jeb_fs->cfg.bcache_shards];
+    *bucketp = &shard->buckets[h & shard->bucket_mask];
+    return (shard);
+}
+
+/* take an entry off its hash chain and the CLOCK ring and free it. shard lock held */
+static void
+jeb_bc_remove(JEB_BC_SHARD *shard, JEB_BC_ENTRY **prevp, JEB_BC_ENTRY *entry) {
+    *prevp = entry->hnext;
+    if (entry->next == entry)
+        shard->hand = NULL;
+    else {
+        if (shard->hand == entry)
+            shard->hand = entry->next;
+        entry->prev->next = entry->next;
+        entry->next->prev = entry->prev;
+    }
+    shard->bytes -= sizeof(JEB_BC_ENTRY) + entry->len;
+    free(entry);
+}
+
+/* find entry's link in its hash chain. shard lock held */
+static JEB_BC_ENTRY **
+jeb_bc_chain_link(JEB_FILE_SYSTEM *jeb_fs, JEB_BC_ENTRY *entry) {
+    JEB_BC_ENTRY **prevp;
+
+    (void)jeb_bc_locate(jeb_fs, entry->file_id, (uint64_t)entry->off >> JEB_BC_GRANULE_SHIFT, &prevp);
+    while (*prevp != entry)
+        prevp = &(*prevp)->hnext;
+    return (prevp);
+}
+
+static int
+jeb_bcache_init(JEB_FILE_SYSTEM *jeb_fs) {
+    JEB_BC_SHARD *shard;
+    uint64_t nbuckets;
+    uint32_t nshards;
+
+    nshards = jeb_fs->cfg.bcache_shards;
+    if ((jeb_fs->bcache = aligned_alloc(JEB_CACHE_LINE, nshards * sizeof(JEB_BC_SHARD))) == NULL)
+        return (ENOMEM);
+    memset(jeb_fs->bcache, 0, nshards * sizeof(JEB_BC_SHARD));
+
+    // about one bucket per 4KB block the budget could hold
+    for (nbuckets = 64; nbuckets * 4096 * nshards < jeb_fs->cfg.bcache_size; nbuckets <<= 1)
+        ;
+    for (uint32_t i = 0; i < nshards; i++) {
+        shard = &jeb_fs->bcache[i];
+        pthread_mutex_init(&shard->lock, NULL);
+        shard->budget = jeb_fs->cfg.bcache_size / nshards;
+        shard->bucket_mask = (uint32_t)nbuckets - 1;
+        if ((shard->buckets = calloc(nbuckets, sizeof(JEB_BC_ENTRY *))) == NULL) {
+            while (i-- > 0)
+                free(jeb_fs->bcache[i].buckets);
+            free(jeb_fs->bcache);
+            jeb_fs->bcache = NULL;
+            return (ENOMEM);
+        }
+    }
+    return (0);
+}
+
+static void
+jeb_bcache_destroy(JEB_FILE_SYSTEM *jeb_fs) {
+    JEB_BC_ENTRY *entry, *next;
+    JEB_BC_SHARD *shard;
+
+    if (jeb_fs->bcache == NULL)
+        return;
+    for (uint32_t i = 0; i < jeb_fs->cfg.bcache_shards; i++) {
+        shard = &jeb_fs->bcache[i];
+        for (uint32_t b = 0; b <= shard->bucket_mask; b++)
+            for (entry = shard->buckets[b]; entry != NULL; entry = next) {
+                next = entry->hnext;
+                free(entry);
+            }
+        free(shard->buckets);
+        pthread_mutex_destroy(&shard->lock);
+    }
+    free(jeb_fs->bcache);
+    jeb_fs->bcache = NULL;
+}
+
+/*
+* copy a cached block into buf. on a miss, *genp gets the shard's generation for a later
+* jeb_bcache_insert(). returns true on a hit.
+*/
+static bool
+jeb_bcache_lookup(JEB_FILE_HANDLE *fh, wt_off_t offset, size_t len, char *buf, uint64_t *genp) {
+    JEB_BC_ENTRY **bucket, *entry;
+    JEB_BC_SHARD *shard;
+
+    shard = jeb_bc_locate(fh->fs, fh->file_id, (uint64_t)offset >> JEB_BC_GRANULE_SHIFT, &bucket);
+    pthread_mutex_lock(&shard->lock);
+    for (entry = *bucket; entry != NULL; entry = entry->hnext)
+        if (entry->file_id == fh->file_id && entry->off == offset && entry->len == len) {
+            memcpy(buf, entry->data, len);
+            entry->ref = true;
+            ++shard->hits;
+            pthread_mutex_unlock(&shard->lock);
+            return (true);
+        }
+    ++shard->misses;
+    *genp = shard->gen;
+    pthread_mutex_unlock(&shard->lock);
+    return (false);
+}
+
+/*
+* add a block read from disk. skipped if anything was invalidated in the shard since the
+* miss, the block might be stale. CLOCK makes room: referenced entries get a second
+* chance, new ones start unreferenced so one-off reads go first.
+*/
+static void
+jeb_bcache_insert(JEB_FILE_HANDLE *fh, wt_off_t offset, size_t len, const char *buf, uint64_t gen) {
+    JEB_FILE_SYSTEM *jeb_fs;
+    JEB_BC_ENTRY **bucket, *entry, *victim;
+    JEB_BC_SHARD *shard;
+    size_t need;
+
+    jeb_fs = fh->fs;
+    need = sizeof(JEB_BC_ENTRY) + len;
+    if ((entry = malloc(need)) == NULL)
+        return;
+    entry->file_id = fh->file_id;
+    entry->off = offset;
+    entry->len = len;
+    entry->ref = false;
+    memcpy(entry->data, buf, len);
+
+    shard = jeb_bc_locate(jeb_fs, fh->file_id, (uint64_t)offset >> JEB_BC_GRANULE_SHIFT, &bucket);
+    pthread_mutex_lock(&shard->lock);
+    if (shard->gen != gen || need > shard->budget) {
+        pthread_mutex_unlock(&shard->lock);
+        free(entry);
+        return;
+    }
+
+    // another reader may have raced us in
+    for (victim = *bucket; victim != NULL; victim = victim->hnext)
+        if (victim->file_id == fh->file_id && victim->off == offset && victim->len == len) {
+            pthread_mutex_unlock(&shard->lock);
+            free(entry);
+            return;
+        }
+
+    while (shard->bytes + need > shard->budget) {
+        victim = shard->hand;
+        shard->hand = victim->next;
+        if (victim->ref) {
+            victim->ref = false;
+            continue;
+        }
+        jeb_bc_remove(shard, jeb_bc_chain_link(jeb_fs, victim), victim);
+        JEB_STAT_INCR(jeb_fs, bc_evictions);
+    }
+
+    entry->hnext = *bucket;
+    *bucket = entry;
+    if (shard->hand == NULL) {
+        entry->prev = entry->next = entry;
+        shard->hand = entry;
+    } else {
+        entry->next = shard->hand;
+        entry->prev = shard->hand->prev;
+        entry->prev->next = entry;
+        shard->hand->prev = entry;
+    }
+    shard->bytes += need;
+    pthread_mutex_unlock(&shard->lock);
+    JEB_STAT_INCR(jeb_fs, bc_inserts);
+}
+
+/*
+* drop cached blocks of this file overlapping [offset, end). an entry starts at most one
+* granule before anything it overlaps, so only those granules' chains need a look.
+*/
+static void
+jeb_bcache_invalidate(JEB_FILE_HANDLE *fh, wt_off_t offset, wt_off_t end) {
+    JEB_BC_ENTRY **bucket, **prevp, *entry;
+    JEB_BC_SHARD *shard;
+    uint64_t g, first, last;
+
+    first = (uint64_t)offset >> JEB_BC_GRANULE_SHIFT;
+    first = first == 0 ? 0 : first - 1;
+    last = (uint64_t)(end - 1) >> JEB_BC_GRANULE_SHIFT;
+    for (g = first; g <= last; g++) {
+        shard = jeb_bc_locate(fh->fs, fh->file_id, g, &bucket);
+        pthread_mutex_lock(&shard->lock);
+        ++shard->gen;
+        for (prevp = bucket; (entry = *prevp) != NULL;)
+            if (entry->file_id == fh->file_id && entry->off < end &&
+              entry->off + (wt_off_t)entry->len > offset)
+                jeb_bc_remove(shard, prevp, entry);
+            else
+                prevp = &entry->hnext;
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
+/* drop everything cached for this file at or past offset, for truncate and close; walks every shard */
+static void
+jeb_bcache_invalidate_tail(JEB_FILE_HANDLE *fh, wt_off_t offset) {
+    JEB_BC_ENTRY **prevp, *entry;
+    JEB_BC_SHARD *shard;
+
+    for (uint32_t i = 0; i < fh->fs->cfg.bcache_shards; i++) {
+        shard = &fh->fs->bcache[i];
+        pthread_mutex_lock(&shard->lock);
+        ++shard->gen;
+        for (uint32_t b = 0; b <= shard->bucket_mask; b++)
+            for (prevp = &shard->buckets[b]; (entry = *prevp) != NULL;)
+                if (entry->file_id == fh->file_id && entry->off + (wt_off_t)entry->len > offset)
+                    jeb_bc_remove(shard, prevp, entry);
+                else
+                    prevp = &entry->hnext;
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+/* ! [JEB :: BLOCK CACHE] */
+
+/* ! [JEB :: METADATA CACHE] */
+static int
+jeb_meta_init(JEB_FILE_SYSTEM *jeb_fs) {
+    if ((jeb_fs->meta = calloc(JEB_META_BUCKETS, sizeof(JEB_META_ENTRY *))) == NULL)
+        return (ENOMEM);
+    pthread_mutex_init(&jeb_fs->meta_lock, NULL);
+    return (0);
+}
+
+static void
+jeb_meta_destroy(JEB_FILE_SYSTEM *jeb_fs) {
+    JEB_META_ENTRY *entry, *next;
+
+    if (jeb_fs->meta == NULL)
+        return;
+    for (uint32_t b = 0; b < JEB_META_BUCKETS; b++)
+        for (entry = jeb_fs->meta[b]; entry != NULL; entry = next) {
+            next = entry->next;
+            free(entry);
+        }
+    free(jeb_fs->meta);
+    jeb_fs->meta = NULL;
+    pthread_mutex_destroy(&jeb_fs->meta_lock);
+}
+
+/* FNV-1a, for the tables keyed by path */
+static uint32_t
+jeb_name_hash(const char *name) {
+    uint32_t h = 2166136261u;
+
+    for (const char *p = name; *p != '\0'; p++)
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    return (h);
+}
+
+/* name's entry, or NULL; *prevp gets the link pointing at it (or where it would go). meta_lock held. */
+static JEB_META_ENTRY *
+jeb_meta_find(JEB_FILE_SYSTEM *jeb_fs, const char *name, JEB_META_ENTRY ***prevp) {
+    JEB_META_ENTRY **prev, *entry;
+
+    for (prev = &jeb_fs->meta[jeb_name_hash(name) & (JEB_META_BUCKETS - 1)]; (entry = *prev) != NULL; prev = &entry->next)
+        if (strcmp(entry->name, name) == 0)
+            break;
+    if (prevp != NULL)
+        *prevp = prev;
+    return (entry);
+}
+
+/* name's entry, added if it's not there and there's room; NULL otherwise. meta_lock held. */
+static JEB_META_ENTRY *
+jeb_meta_get(JEB_FILE_SYSTEM *jeb_fs, const char *name) {
+    JEB_META_ENTRY **prev, *entry;
+    size_t len;
+
+    if ((entry = jeb_meta_find(jeb_fs, name, &prev)) != NULL)
+        return (entry);
+    len = strlen(name) + 1;
+    if (jeb_fs->nmeta >= JEB_META_MAX || (entry = calloc(1, sizeof(JEB_META_ENTRY) + len)) == NULL)
+        return (NULL);
+    memcpy(entry->name, name, len);
+    entry->exists = -1;
+    entry->size = -1;
+    *prev = entry;
+    ++jeb_fs->nmeta;
+    return (entry);
+}
+
+/*
+* answer fs_exist (sizep NULL) or fs_size from the cache. *retp gets ENOENT for the size of
+* a file known not to exist. on a miss, *genp is for jeb_meta_store() once the statx is back.
+*/
+static bool
+jeb_meta_lookup(JEB_FILE_SYSTEM *jeb_fs, const char *name, bool *existp, wt_off_t *sizep,
+    int *retp, uint64_t *genp) {
+    JEB_META_ENTRY *entry;
+    bool hit = false;
+
+    *retp = 0;
+    pthread_mutex_lock(&jeb_fs->meta_lock);
+    *genp = jeb_fs->meta_gen;
+    if ((entry = jeb_meta_find(jeb_fs, name, NULL)) != NULL && entry->exists >= 0) {
+        if (sizep == NULL) {
+            *existp = entry->exists == 1;
+            hit = true;
+        } else if (entry->exists == 0) {
+            *retp = ENOENT;
+            hit = true;
+        } else if (entry->fh != NULL && __atomic_load_n(&entry->fh->size_known, __ATOMIC_ACQUIRE)) {
+            *sizep = __atomic_load_n(&entry->fh->size, __ATOMIC_RELAXED);
+            hit = true;
+        } else if (entry->nopen == 0 && entry->size >= 0) {
+            *sizep = entry->size;
+            hit = true;
+        }
+    }
+    pthread_mutex_unlock(&jeb_fs->meta_lock);
+
+    if (hit)
+        JEB_TSTAT_INCR(jeb_fs, meta_hits, 1);
+    else
+        JEB_TSTAT_INCR(jeb_fs, meta_misses, 1);
+    return (hit);
+}
+
+/* cache what a statx of name found, unless something changed the name since gen */
+static void
+jeb_meta_store(JEB_FILE_SYSTEM *jeb_fs, const char *name, bool exists, wt_off_t size, uint64_t gen) {
+    JEB_META_ENTRY *entry;
+
+    pthread_mutex_lock(&jeb_fs->meta_lock);
+    if (jeb_fs->meta_gen == gen && (entry = jeb_meta_get(jeb_fs, name)) != NULL) {
+        entry->exists = exists ? 1 : 0;
+        if (entry->nopen == 0)
+            entry->size = exists ? size : -1;
+    }
+    pthread_mutex_unlock(&jeb_fs->meta_lock);
+}
+
+/*
+* forget name after a remove or rename. an entry with handles open stays for their
+* accounting, but with nothing known about it.
+*/
+static void
+jeb_meta_invalidate(JEB_FILE_SYSTEM *jeb_fs, const char *name) {
+    JEB_META_ENTRY **prev, *entry;
+
+    if (jeb_fs->meta == NULL)
+        return;
+    pthread_mutex_lock(&jeb_fs->meta_lock);
+    ++jeb_fs->meta_gen;
+    if ((entry = jeb_meta_find(jeb_fs, name, &prev)) != NULL) {
+        if (entry->nopen == 0) {
+            *prev = entry->next;
+            free(entry);
+            --jeb_fs->nmeta;
+        } else {
+            entry->fh = NULL;
+            entry->exists = -1;
+            entry->size = -1;
+        }
+    }
+    pthread_mutex_unlock(&jeb_fs->meta_lock);
+}
+
+/*
+* a handle was opened on the file: it exists now, and its size is the handle's business
+* until it's closed. a file nobody had open hands its cached size to the handle.
+*/
+static void
+jeb_meta_opened(JEB_FILE_HANDLE *fh) {
+    JEB_FILE_SYSTEM *jeb_fs = fh->fs;
+    JEB_META_ENTRY *entry;
+
+    pthread_mutex_lock(&jeb_fs->meta_lock);
+    ++jeb_fs->meta_gen;
+    if ((entry = jeb_meta_get(jeb_fs, fh->iface.name)) != NULL) {
+        if (entry->nopen == 0 && entry->exists == 1 && entry->size >= 0) {
+            fh->size = entry->size;
+            fh->size_known = true;
+        }
+        entry->fh = entry->nopen++ == 0 ? fh : NULL;
+        entry->exists = 1;
+        entry->size = -1;
+        fh->meta_tracked = true;
+    }
+    pthread_mutex_unlock(&jeb_fs->meta_lock);
+}
+
+/* whether a handle is open on name, as far as the cache knows */
+static bool
+jeb_meta_is_open(JEB_FILE_SYSTEM *jeb_fs, const char *name) {
+    JEB_META_ENTRY *entry;
+    bool open;
+
+    pthread_mutex_lock(&jeb_fs->meta_lock);
+    open = (entry = jeb_meta_find(jeb_fs, name, NULL)) != NULL && entry->nopen > 0;
+    pthread_mutex_unlock(&jeb_fs->meta_lock);
+    return (open);
+}
+
+/* the handle's being closed; if it was the last one, its size is the file's */
+static void
+jeb_meta_closed(JEB_FILE_HANDLE *fh) {
+    JEB_FILE_SYSTEM *jeb_fs = fh->fs;
+    JEB_META_ENTRY *entry;
+
+    if (!fh->meta_tracked)
+        return;
+    pthread_mutex_lock(&jeb_fs->meta_lock);
+    ++jeb_fs->meta_gen;
+    if ((entry = jeb_meta_find(jeb_fs, fh->iface.name, NULL)) != NULL && entry->nopen > 0) {
+        if (--entry->nopen == 0 && entry->exists == 1)
+            entry->size = entry->fh == fh && fh->size_known ? fh->size : -1;
+        if (entry->fh == fh)
+            entry->fh = NULL;
+    }
+    pthread_mutex_unlock(&jeb_fs->meta_lock);
+}
+
+/* the file is at least end bytes long now */
+static void
+jeb_fh_size_grow(JEB_FILE_HANDLE *fh, wt_off_t end) {
+    wt_off_t cur;
+
+    cur = __atomic_load_n(&fh->size, __ATOMIC_RELAXED);
+    while (end > cur &&
+      !__atomic_compare_exchange_n(&fh->size, &cur, end, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        ;
+}
+/* ! [JEB :: METADATA CACHE] */
+
+/* ! [JEB :: OPEN PREFETCH] */
+/* path's entry, or NULL; *prevp gets the link pointing at it (or where it would go). pf_lock held. */
+static JEB_PF_ENTRY *
+jeb_pf_find(JEB_FILE_SYSTEM *jeb_fs, const char *path, JEB_PF_ENTRY ***prevp) {
+    JEB_PF_ENTRY **prev, *entry;
+
+    for (prev = &jeb_fs->pf[jeb_name_hash(path) & (JEB_PF_BUCKETS - 1)]; (entry = *prev) != NULL; prev = &entry->hnext)
+        if (strcmp(entry->path, path) == 0)
+            break;
+    *prevp = prev;
+    return (entry);
+}
+
+/*
+* take entry out of the hash, closing its fd if it still has one. an entry the prefetch
+* thread hasn't finished with is left for it to free. pf_lock held.
+*/
+static void
+jeb_pf_unlink(JEB_FILE_SYSTEM *jeb_fs, JEB_PF_ENTRY **prevp, JEB_PF_ENTRY *entry) {
+    *prevp = entry->hnext;
+    if (entry->state != JEB_PF_OPEN) {
+        entry->dropped = true;
+        return;
+    }
+    if (entry->fd >= 0)
+        (void)close(entry->fd);
+    --jeb_fs->npf;
+    free(entry);
+}
+
+/* queue the .wt files from a directory listing for the prefetch thread */
+static void
+jeb_pf_queue(JEB_FILE_SYSTEM *jeb_fs, const char *directory, char **names, uint32_t count) {
+    JEB_PF_ENTRY **prev, *entry;
+    size_t dlen, nlen;
+    bool queued = false;
+
+    dlen = strlen(directory);
+    pthread_mutex_lock(&jeb_fs->pf_lock);
+    for (uint32_t i = 0; i < count && jeb_fs->npf < jeb_fs->cfg.prefetch_files; i++) {
+        nlen = strlen(names[i]);
+        if (nlen < 3 || strcmp(names[i] + nlen - 3, ".wt") != 0)
+            continue;
+        if ((entry = calloc(1, sizeof(JEB_PF_ENTRY) + dlen + nlen + 2)) == NULL)
+            break;
+        // the same path WT builds when it opens the file
+        (void)snprintf(entry->path, dlen + nlen + 2, "%s%s%s",
+          directory, dlen > 0 && directory[dlen - 1] == '/' ? "" : "/", names[i]);
+        // WT lists the home again later (backups, drops); files it has open won't be reopened
+        if (jeb_pf_find(jeb_fs, entry->path, &prev) != NULL ||
+          (jeb_fs->meta != NULL && jeb_meta_is_open(jeb_fs, entry->path))) {
+            free(entry);
+            continue;
+        }
+        entry->state = JEB_PF_QUEUED;
+        entry->fd = -1;
+        *prev = entry;
+        *jeb_fs->pf_tailp = entry;
+        jeb_fs->pf_tailp = &entry->qnext;
+        ++jeb_fs->npf;
+        queued = true;
+    }
+    if (queued)
+        pthread_cond_signal(&jeb_fs->pf_cond);
+    pthread_mutex_unlock(&jeb_fs->pf_lock);
+}
+
+/*
+* the fd the prefetch thread opened for path, if it was opened with the flags fs_open
+* wants. waits for an open that's in flight; one that's still queued is dropped, the
+* caller opening it itself is quicker. returns -1 if there's nothing to claim.
+*/
+static int
+jeb_pf_claim(JEB_FILE_SYSTEM *jeb_fs, const char *path, int open_flags) {
+    JEB_PF_ENTRY **prev, *entry;
+    int fd = -1;
+
+    pthread_mutex_lock(&jeb_fs->pf_lock);
+    // look it up again after every wakeup, it may be gone by then
+    while ((entry = jeb_pf_find(jeb_fs, path, &prev)) != NULL && entry->state == JEB_PF_OPENING)
+        pthread_cond_wait(&jeb_fs->pf_done, &jeb_fs->pf_lock);
+    if (entry != NULL) {
+        // O_CREAT makes no difference to a file that's already there
+        if (entry->state == JEB_PF_OPEN && (open_flags & ~O_CREAT) == jeb_fs->pf_open_flags) {
+            fd = entry->fd;
+            entry->fd = -1;
+        }
+        jeb_pf_unlink(jeb_fs, prev, entry);
+    }
+    pthread_mutex_unlock(&jeb_fs->pf_lock);
+
+    if (fd >= 0)
+        JEB_STAT_INCR(jeb_fs, pf_claimed);
+    return (fd);
+}
+
+/* after a remove or rename, a prefetched fd for path would be for the wrong file */
+static void
+jeb_pf_invalidate(JEB_FILE_SYSTEM *jeb_fs, const char *path) {
+    JEB_PF_ENTRY **prev, *entry;
+
+    if (jeb_fs->pf == NULL)
+        return;
+    pthread_mutex_lock(&jeb_fs->pf_lock);
+    if ((entry = jeb_pf_find(jeb_fs, path, &prev)) != NULL)
+        jeb_pf_unlink(jeb_fs, prev, entry);
+    pthread_mutex_unlock(&jeb_fs->pf_lock);
+}
+
+/* close the prefetched fds nobody claimed in time. pf_lock held. */
+static void
+jeb_pf_sweep(JEB_FILE_SYSTEM *jeb_fs, uint64_t now) {
+    JEB_PF_ENTRY **prev, *entry;
+
+    for (uint32_t b = 0; b < JEB_PF_BUCKETS; b++)
+        for (prev = &jeb_fs->pf[b]; (entry = *prev) != NULL;)
+            if (entry->state == JEB_PF_OPEN && entry->deadline_ns <= now)
+                jeb_pf_unlink(jeb_fs, prev, entry);
+            else
+                prev = &entry->hnext;
+}
+
+/*
+* open queued files a batch at a time: up to JEB_CHUNK_MAX (or queue_depth) openat SQEs
+* submitted together under one completion slot, so the kernel works on them in parallel.
+*/
+static void *
+jeb_pf_thread(void *data) {
+    JEB_FILE_SYSTEM *jeb_fs = (JEB_FILE_SYSTEM *)data;
+    JEB_PF_ENTRY *batch[JEB_CHUNK_MAX], **prev, *entry;
+    JEB_RING *ring;
+    RING_EVENT_USER_DATA *ud;
+    struct io_uring_sqe *sqe;
+    struct timespec deadline;
+    uint64_t now;
+    uint32_t max, n;
+    int res[JEB_CHUNK_MAX];
+
+    max = jeb_fs->cfg.queue_depth < JEB_CHUNK_MAX ? jeb_fs->cfg.queue_depth : JEB_CHUNK_MAX;
+
+    pthread_mutex_lock(&jeb_fs->pf_lock);
+    while (!jeb_fs->pf_stop) {
+        jeb_pf_sweep(jeb_fs, jeb_now_ns());
+        if (jeb_fs->pf_queue == NULL) {
+            // idle: wake for new work, or to sweep again half a timeout from now
+            (void)clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += (long)(jeb_fs->cfg.prefetch_timeout_ms / 2 + 1) * 1000000;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000;
+            deadline.tv_nsec %= 1000000000;
+            (void)pthread_cond_timedwait(&jeb_fs->pf_cond, &jeb_fs->pf_lock, &deadline);
+            continue;
+        }
+
+        for (n = 0; n < max && (entry = jeb_fs->pf_queue) != NULL;) {
+            jeb_fs->pf_queue = entry->qnext;
+            if (entry->dropped) {
+                --jeb_fs->npf;
+                free(entry);
+                continue;
+            }
+            entry->state = JEB_PF_OPENING;
+            batch[n++] = entry;
+        }
+        if (jeb_fs->pf_queue == NULL)
+            jeb_fs->pf_tailp = &jeb_fs->pf_queue;
+        pthread_mutex_unlock(&jeb_fs->pf_lock);
+
+        if (n != 0) {
+            ring = jeb_ring_select(jeb_fs, NULL);
+            jeb_ring_admit(ring, n);
+            ud = jeb_ud_get(jeb_fs, EVENT_TYPE_CHUNKED);
+            ud->pending = n;
+            ud->chunk_res = res;
+            pthread_mutex_lock(&ring->sq_lock);
+            for (uint32_t i = 0; i < n; i++) {
+                sqe = jeb_ring_next_sqe(ring);
+                io_uring_prep_openat(sqe, AT_FDCWD, batch[i]->path, jeb_fs->pf_open_flags, 0);
+                io_uring_sqe_set_data(sqe, (void *)((uintptr_t)ud | i));
+            }
+            jeb_ring_submit_unlock(ring);
+            (void)jeb_ring_wait(ring, ud);
+            jeb_ud_put(jeb_fs, ud);
+        }
+
+        now = jeb_now_ns();
+        pthread_mutex_lock(&jeb_fs->pf_lock);
+        for (uint32_t i = 0; i < n; i++) {
+            entry = batch[i];
+            if (entry->dropped) {
+                if (res[i] >= 0)
+                    (void)close(res[i]);
+                --jeb_fs->npf;
+                free(entry);
+                continue;
+            }
+            entry->state = JEB_PF_OPEN;
+            entry->fd = res[i] >= 0 ? res[i] : -1;
+            entry->deadline_ns = now + (uint64_t)jeb_fs->cfg.prefetch_timeout_ms * 1000000;
+            // a failed open is fs_open's to report, when (if) WT gets there
+            if (res[i] < 0 && jeb_pf_find(jeb_fs, entry->path, &prev) == entry)
+                jeb_pf_unlink(jeb_fs, prev, entry);
+            else
+                JEB_STAT_INCR(jeb_fs, pf_opened);
+        }
+        pthread_cond_broadcast(&jeb_fs->pf_done);
+    }
+    pthread_mutex_unlock(&jeb_fs->pf_lock);
+    return (NULL);
+}
+
+static int
+jeb_pf_init(JEB_FILE_SYSTEM *jeb_fs) {
+    struct rlimit rl;
+    int ret;
+
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY &&
+      jeb_fs->cfg.prefetch_files > rl.rlim_cur / 2)
+        jeb_fs->cfg.prefetch_files = (uint32_t)(rl.rlim_cur / 2);
+    if (jeb_fs->cfg.prefetch_files == 0)
+        return (0);
+
+    // what jeb_fs_open asks for on an existing data file. O_DIRECT is left to jeb_fs_open
+    // to switch on after the claim, where it copes with a file system that won't have it
+    jeb_fs->pf_open_flags = O_RDWR | O_CLOEXEC;
+
+    if ((jeb_fs->pf = calloc(JEB_PF_BUCKETS, sizeof(JEB_PF_ENTRY *))) == NULL)
+        return (ENOMEM);
+    jeb_fs->pf_tailp = &jeb_fs->pf_queue;
+    pthread_mutex_init(&jeb_fs->pf_lock, NULL);
+    pthread_cond_init(&jeb_fs->pf_cond, NULL);
+    pthread_cond_init(&jeb_fs->pf_done, NULL);
+    if ((ret = pthread_create(&jeb_fs->pf_thread, NULL, jeb_pf_thread, jeb_fs)) != 0) {
+        pthread_cond_destroy(&jeb_fs->pf_done);
+        pthread_cond_destroy(&jeb_fs->pf_cond);
+        pthread_mutex_destroy(&jeb_fs->pf_lock);
+        free(jeb_fs->pf);
+        jeb_fs->pf = NULL;
+        return (ret);
+    }
+    return (0);
+}
+
+/* stop the prefetch thread and close everything it opened that nobody claimed */
+static void
+jeb_pf_destroy(JEB_FILE_SYSTEM *jeb_fs) {
+    JEB_PF_ENTRY *entry, *next;
+
+    if (jeb_fs->pf == NULL)
+        return;
+    pthread_mutex_lock(&jeb_fs->pf_lock);
+    jeb_fs->pf_stop = true;
+    pthread_cond_signal(&jeb_fs->pf_cond);
+    pthread_mutex_unlock(&jeb_fs->pf_lock);
+    (void)pthread_join(jeb_fs->pf_thread, NULL);
+
+    // the thread is gone, so nothing is in flight: the queue holds every entry not yet
+    // opened (dropped or not), the hash every opened one
+    for (entry = jeb_fs->pf_queue; entry != NULL; entry = next) {
+        next = entry->qnext;
+        if (entry->dropped)
+            free(entry);
+    }
+    for (uint32_t b = 0; b < JEB_PF_BUCKETS; b++)
+        for (entry = jeb_fs->pf[b]; entry != NULL; entry = next) {
+            next = entry->hnext;
+            if (entry->fd >= 0)
+                (void)close(entry->fd);
+            free(entry);
+        }
+    free(jeb_fs->pf);
+    jeb_fs->pf = NULL;
+    pthread_cond_destroy(&jeb_fs->pf_done);
+    pthread_cond_destroy(&jeb_fs->pf_cond);
+    pthread_mutex_destroy(&jeb_fs->pf_lock);
+}
+/* ! [JEB :: OPEN PREFETCH] */
+
+/* ! [JEB :: WRITE COMBINING] */
+/* drop readahead windows and cached blocks overlapping [offset, end) after it's been written */
+static void
+jeb_fh_cache_invalidate(JEB_FILE_HANDLE *fh, wt_off_t offset, wt_off_t end) {
+    if (end <= offset)
+        return;
+    if (fh->fs->cfg.readahead != 0)
+        jeb_ra_invalidate(fh, offset, end);
+    if (fh->fs->bcache != NULL)
+        jeb_bcache_invalidate(fh, offset, end);
+}
+
+/*
+* wait for w's background write, if it has one, finishing a short write synchronously.
+* a failure is kept in wc_err for the next sync. wc_lock held.
+*/
+static void
+jeb_wc_reap(JEB_FILE_HANDLE *fh, WT_SESSION *session, JEB_WC_BUF *w) {
+    int res, ret = 0;
+
+    if (!jeb_detached_reap(&w->io))
+        return;
+    res = w->io.res[0];
+
+    if (res < 0)
+        ret = -res;
+    else if ((size_t)res < w->len)
+        ret = jeb_fh_rw(fh, session, w->off + res, w->len - (size_t)res, w->buf + res, true);
+    if (ret != 0) {
+        fprintf(stderr, "background write of %zu bytes at offset %" PRId64 " to %s failed: %s\n",
+          w->len, (int64_t)w->off, fh->iface.name, strerror(ret));
+        if (fh->wc_err == 0)
+            fh->wc_err = ret;
+    }
+
+    // readahead may have picked up the old contents while the run sat in memory
+    jeb_fh_cache_invalidate(fh, w->off, w->off + (wt_off_t)w->len);
+    w->len = 0;
+}
+
+/*
+* start writing the current run in the background and switch to the other buffer. that
+* one's write is reaped first, so there's never more than one in flight and runs land in
+* the order they were staged. wc_lock held.
+*/
+static void
+jeb_wc_rotate(JEB_FILE_HANDLE *fh, WT_SESSION *session) {
+    JEB_WC_BUF *cur;
+    JEB_RING *ring;
+    RING_EVENT_USER_DATA *ud;
+    struct io_uring_sqe *sqe;
+
+    jeb_wc_reap(fh, session, &fh->wc[fh->wc_cur ^ 1]);
+    cur = &fh->wc[fh->wc_cur];
+    if (cur->len == 0)
+        return;
+
+    ring = jeb_ring_select(fh->fs, session);
+    jeb_class_enter(fh->fs, ring, JEB_CLASS_BACKGROUND, 1);
+    sqe = jeb_ring_get_sqe(ring);
+    ud = jeb_ud_get_detached(fh->fs, &cur->io, 1);
+    ud->rw_tags = 1;
+    jeb_ud_class(ud, ring, JEB_CLASS_BACKGROUND);
+    io_uring_prep_write(sqe, fh->fd, cur->buf, (uint32_t)cur->len, cur->off);
+    jeb_sqe_fixed_file(ring, sqe, fh);
+    jeb_sqe_ioprio(fh->fs, sqe, JEB_CLASS_BACKGROUND);
+    jeb_ring_submit_nowait(ring, sqe, ud);
+    fh->wc_cur ^= 1;
+}
+
+/* write out everything staged and wait for it; returns (and clears) any background write error */
+static int
+jeb_wc_flush(JEB_FILE_HANDLE *fh, WT_SESSION *session) {
+    int ret;
+
+    pthread_mutex_lock(&fh->wc_lock);
+    jeb_wc_rotate(fh, session);
+    jeb_wc_reap(fh, session, &fh->wc[fh->wc_cur ^ 1]);
+    ret = fh->wc_err;
+    fh->wc_err = 0;
+    pthread_mutex_unlock(&fh->wc_lock);
+    return (ret);
+}
+
+/* before a read: write out anything staged that overlaps [offset, end) */
+static void
+jeb_wc_flush_overlap(JEB_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t offset, wt_off_t end) {
+    JEB_WC_BUF *w;
+    bool overlap = false;
+
+    pthread_mutex_lock(&fh->wc_lock);
+    for (int i = 0; i < 2; i++) {
+        w = &fh->wc[i];
+        if (w->len != 0 && w->off < end && w->off + (wt_off_t)w->len > offset)
+            overlap = true;
+    }
+    if (overlap) {
+        jeb_wc_rotate(fh, session);
+        jeb_wc_reap(fh, session, &fh->wc[fh->wc_cur ^ 1]);
+    }
+    pthread_mutex_unlock(&fh->wc_lock);
+}
+
+/*
+* stage a write. it extends the current run if it starts inside or right at the end of it
+* (overlaps just overwrite the staged bytes); anything else starts a new run. returns false
+* if the write wasn't staged (too big, or no buffers), in which case everything staged
+* before it has already been written, so the caller's direct write lands after it.
+*/
+static bool
+jeb_wc_write(JEB_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t offset, size_t len, const void *buf) {
+    JEB_WC_BUF *cur;
+    size_t cap;
+
+    cap = fh->fs->cfg.write_combine;
+    pthread_mutex_lock(&fh->wc_lock);
+    if (fh->wc[0].buf == NULL) {
+        if (posix_memalign((void **)&fh->wc[0].buf, DIO_DEFAULT_ALIGN, cap) != 0)
+            fh->wc[0].buf = NULL;
+        else if (posix_memalign((void **)&fh->wc[1].buf, DIO_DEFAULT_ALIGN, cap) != 0) {
+            free(fh->wc[0].buf);
+            fh->wc[0].buf = fh->wc[1].buf = NULL;
+        }
+        if (fh->wc[0].buf == NULL) {
+            pthread_mutex_unlock(&fh->wc_lock);
+            return (false);
+        }
+    }
+
+    if (len > cap) {
+        jeb_wc_rotate(fh, session);
+        jeb_wc_reap(fh, session, &fh->wc[fh->wc_cur ^ 1]);
+        pthread_mutex_unlock(&fh->wc_lock);
+        return (false);
+    }
+
+    cur = &fh->wc[fh->wc_cur];
+    if (cur->len != 0 && offset >= cur->off && offset <= cur->off + (wt_off_t)cur->len &&
+      (size_t)(offset - cur->off) + len <= cap) {
+        memcpy(cur->buf + (offset - cur->off), buf, len);
+        if ((size_t)(offset - cur->off) + len > cur->len)
+            cur->len = (size_t)(offset - cur->off) + len;
+    } else {
+        if (cur->len != 0) {
+            jeb_wc_rotate(fh, session);
+            cur = &fh->wc[fh->wc_cur];
+        }
+        cur->off = offset;
+        cur->len = len;
+        memcpy(cur->buf, buf, len);
+    }
+    pthread_mutex_unlock(&fh->wc_lock);
+    return (true);
+}
+/* ! [JEB :: WRITE COMBINING] */
+
+/*
+* function exxecuted by a bg thread (one per ring) to block on the eventfd, and when it awakens,
+* check the ring for CQEs. For each CQE available, poke the "lock"
+* in the user_data to awaken the blocked read/write thread.
+*
+* This thread will not free any memory.
+*/
+void *ring_consumer(void *data) {
+    JEB_RING *ring = (JEB_RING *) data;
+    WT_EXTENSION_API *wtext = ring->fs->wtext;
+    eventfd_t v;
+    bool logged = false;
+
+    while (!__atomic_load_n(&ring->must_exit, __ATOMIC_ACQUIRE)) {
+        // this blocks forever ... i think :(
+        if (eventfd_read(ring->efd, &v) < 0) {
+            if (errno == EINTR)
+                continue;
+            // waiters still need their CQEs. without the eventfd to block on, poll the
+            // ring every millisecond instead, and only say so the once
+            if (!logged) {
+                (void)wtext->err_printf(wtext, NULL, "ring %u: eventfd read failed, polling instead: %s",
+                        ring->id, wtext->strerror(wtext, NULL, errno));
+                logged = true;
+            }
+            (void)usleep(1000);
+        }
+
+        // make sure we get all the CQEs that are ready, else we won't get
+        // re-notified from the eventfd blocking. with submitter_reap a waiter may have
+        // beaten us to them, in which case there's nothing to do. every CQE posted after
+        // this drain bumps the eventfd again, so nothing gets stranded.
+        pthread_mutex_lock(&ring->cq_lock);
+        (void)jeb_ring_reap(ring);
+        pthread_mutex_unlock(&ring->cq_lock);
+    }
+
+    return (NULL);
+}
+
+/* count the NUMA nodes the kernel knows about; a box without NUMA has one. */
+static uint32_t
+jeb_numa_node_count(void) {
+    struct dirent *dp;
+    DIR *dirp;
+    uint32_t count = 0;
+
+    if ((dirp = opendir("/sys/devices/system/node")) == NULL)
+        return (1);
+    while ((dp = readdir(dirp)) != NULL) {
+        if (strncmp(dp->d_name, "node", 4) == 0 && dp->d_name[4] >= '0' && dp->d_name[4] <= '9')
+            ++count;
+    }
+    (void)closedir(dirp);
+    return (count == 0 ? 1 : count);
+}
+
+/*
+* stop the consumer threads and close the rings and their eventfds, as far as
+* jeb_rings_init() got with them. used at terminate, and when setup fails part way.
+*/
+static void
+jeb_rings_destroy(JEB_FILE_SYSTEM *fs) {
+    JEB_RING *ring;
+    struct io_uring_sqe *sqe;
+
+    for (uint32_t i = 0; fs->rings != NULL && i < fs->nrings; i++) {
+        ring = &fs->rings[i];
+        if (ring->consumer_running) {
+            sqe = jeb_ring_get_sqe(ring);
+            io_uring_prep_nop(sqe);
+            (void)jeb_ring_submit_and_wait(ring, sqe, EVENT_TYPE_SHUTDOWN);
+            (void)pthread_join(ring->uring_consumer, NULL);
+        }
+        if (ring->initialized)
+            io_uring_queue_exit(&ring->ring);
+        if (ring->efd >= 0 && close(ring->efd) != 0)
+            fprintf(stderr, "problem closing eventd used with io_uring. ignoring but error is %s\n", strerror(errno));
+        pthread_mutex_destroy(&ring->sq_lock);
+        pthread_mutex_destroy(&ring->cq_lock);
+    }
+    free(fs->rings);
+    fs->rings = NULL;
+
+    for (uint32_t i = 0; fs->poll_rings != NULL && i < fs->nrings; i++) {
+        ring = &fs->poll_rings[i];
+        if (ring->initialized)
+            io_uring_queue_exit(&ring->ring);
+        pthread_mutex_destroy(&ring->sq_lock);
+        pthread_mutex_destroy(&ring->cq_lock);
+    }
+    free(fs->poll_rings);
+    fs->poll_rings = NULL;
+}
+
+/*
+* create the IOPOLL twin of each ring. they share the main rings' file table layout and
+* registered buffers, since O_DIRECT reads/writes are all they ever see. on failure,
+* jeb_rings_init() tears down whatever got created.
+*/
+static int
+jeb_poll_rings_init(JEB_FILE_SYSTEM *fs) {
+    JEB_RING *ring;
+    int ret;
+
+    if ((fs->poll_rings = aligned_alloc(JEB_CACHE_LINE, fs->nrings * sizeof(JEB_RING))) == NULL)
+        return (ENOMEM);
+    memset(fs->poll_rings, 0, fs->nrings * sizeof(JEB_RING));
+    for (uint32_t i = 0; i < fs->nrings; i++) {
+        ring = &fs->poll_rings[i];
+        ring->id = i;
+        ring->fs = fs;
+        ring->efd = -1;
+        ring->iopoll = true;
+        ring->adm_limit = fs->cfg.adm_max_depth;
+        pthread_mutex_init(&ring->sq_lock, NULL);
+        pthread_mutex_init(&ring->cq_lock, NULL);
+    }
+
+    for (uint32_t i = 0; i < fs->nrings; i++) {
+        ring = &fs->poll_rings[i];
+        if ((ret = init_io_uring(&ring->ring, &fs->cfg, -1, fs->rings[0].ring.ring_fd, true)) != 0)
+            return (ret);
+        ring->initialized = true;
+        if (fs->nfile_slots != 0 && (ret = io_uring_register_files_sparse(&ring->ring, fs->nfile_slots)) < 0) {
+            (void)fs->wtext->err_printf(fs->wtext, NULL, "failed to register file table with IOPOLL ring %u: %s",
+                    i, fs->wtext->strerror(fs->wtext, NULL, -ret));
+            return (-ret);
+        }
+        if (fs->regbufs.nslots != 0 && (ret = jeb_bufpool_register(&fs->regbufs, &ring->ring)) != 0) {
+            (void)fs->wtext->err_printf(fs->wtext, NULL, "failed to register %u buffers with IOPOLL ring %u: %s",
+                    fs->regbufs.nslots, i, fs->wtext->strerror(fs->wtext, NULL, ret));
+            return (ret);
+        }
+    }
+    return (0);
+}
+
+/*
+* create fs->nrings rings, each with its own eventfd and consumer thread. all rings after
+* the first attach to its SQPOLL thread.
+*/
+static int
+jeb_rings_init(JEB_FILE_SYSTEM *fs) {
+    JEB_RING *ring;
+    int efd, ret;
+
+    fs->nrings = fs->cfg.rings;
+    if (fs->nrings == 0) {
+        if (fs->cfg.ring_topology == RING_TOPOLOGY_NUMA)
+            fs->nrings = jeb_numa_node_count();
+        else
+            fs->nrings = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (fs->nrings == 0)
+        fs->nrings = 1;
+    if (fs->nrings > JEB_MAX_RINGS)
+        fs->nrings = JEB_MAX_RINGS;
+
+    if ((fs->rings = aligned_alloc(JEB_CACHE_LINE, fs->nrings * sizeof(JEB_RING))) == NULL)
+        return (ENOMEM);
+    memset(fs->rings, 0, fs->nrings * sizeof(JEB_RING));
+    for (uint32_t i = 0; i < fs->nrings; i++) {
+        ring = &fs->rings[i];
+        ring->id = i;
+        ring->fs = fs;
+        ring->efd = -1;
+        ring->adm_limit = fs->cfg.adm_max_depth;
+        pthread_mutex_init(&ring->sq_lock, NULL);
+        pthread_mutex_init(&ring->cq_lock, NULL);
+    }
+
+    for (uint32_t i = 0; i < fs->nrings; i++) {
+        ring = &fs->rings[i];
+        efd = eventfd(0, 0);
+        if (efd < 0) {
+            ret = errno;
+            (void)fs->wtext->err_printf(fs->wtext, NULL, "failed to create eventfd: %s",
+                    fs->wtext->strerror(fs->wtext, NULL, ret));
+            goto err;
+        }
+        ring->efd = efd;
+        if ((ret = init_io_uring(&ring->ring, &fs->cfg, efd, i == 0 ? -1 : fs->rings[0].ring.ring_fd, false)) != 0)
+            goto err;
+        ring->initialized = true;
+
+        if (fs->nfile_slots != 0 && (ret = io_uring_register_files_sparse(&ring->ring, fs->nfile_slots)) < 0) {
+            if (i != 0) {
+                (void)fs->wtext->err_printf(fs->wtext, NULL, "failed to register file table with ring %u: %s",
+                        i, fs->wtext->strerror(fs->wtext, NULL, -ret));
+                ret = -ret;
+                goto err;
+            }
+            // most likely an older kernel; carry on with plain fds
+            (void)fs->wtext->err_printf(fs->wtext, NULL, "registered files unavailable (%s), using plain fds",
+                    fs->wtext->strerror(fs->wtext, NULL, -ret));
+            jeb_freelist_destroy(&fs->file_slots);
+            fs->nfile_slots = 0;
+        }
+
+        if (fs->regbufs.nslots != 0 && (ret = jeb_bufpool_register(&fs->regbufs, &ring->ring)) != 0) {
+            (void)fs->wtext->err_printf(fs->wtext, NULL, "failed to register %u buffers with ring %u: %s",
+                    fs->regbufs.nslots, i, fs->wtext->strerror(fs->wtext, NULL, ret));
+            goto err;
+        }
+
+        if ((ret = pthread_create(&ring->uring_consumer, NULL, ring_consumer, (void *)ring)) != 0)
+            goto err;
+        ring->consumer_running = true;
+    }
+
+    if (fs->cfg.iopoll && (ret = jeb_poll_rings_init(fs)) != 0)
+        goto err;
+    return (0);
+
+err:
+    jeb_rings_destroy(fs);
+    return (ret);
+}
+
+/* Check if a WT_CONFIG_ITEM key matches a string. */
+#define JEB_CONFIG_MATCH(k, s) ((k)->len == strlen(s) && strncmp((k)->str, s, (k)->len) == 0)
+
+/*
+* Sub-config keys. Each names a JEB_CONFIG field by offset and says how to store the value:
+* BOOL/U32/U64/INT are plain assignments, FLAG ORs in the given bit and ignores the value
+* (for lists like direct_io=[data,log]).
+*/
+typedef enum {
+    JEB_KEY_BOOL, JEB_KEY_U32, JEB_KEY_U64, JEB_KEY_INT, JEB_KEY_FLAG
+} JEB_CONFIG_KEY_TYPE;
+
+typedef struct {
+    const char *name;
+    JEB_CONFIG_KEY_TYPE type;
+    size_t off;              // offsetof(JEB_CONFIG, field)
+    uint32_t flag;           // JEB_KEY_FLAG only
+} JEB_CONFIG_KEY;
+
+#define JEB_KEY(name, type, field) { name, type, offsetof(JEB_CONFIG, field), 0 }
+#define JEB_KEY_END { NULL, 0, 0, 0 }
+
+/*
+* Parse one sub-config against its key table, "what" names its keys in errors. If enabled is
+* not NULL, a plain bool/number (sqpoll=true) just sets it, and a (...) value turns it on
+* before the keys are applied, so an enabled=false in there still wins.
+*/
+static int
+jeb_config_parse_keys(JEB_FILE_SYSTEM *fs, WT_CONFIG_ITEM *value, const char *what,
+    const JEB_CONFIG_KEY *keys, bool *enabled) {
+    const JEB_CONFIG_KEY *key;
+    WT_CONFIG_ITEM k, v;
+    WT_CONFIG_PARSER *parser;
+    WT_EXTENSION_API *wtext;
+    char *field;
+    int ret, tret;
+
+    wtext = fs->wtext;
+    if (enabled != NULL) {
+        if (value->type != WT_CONFIG_ITEM_STRUCT) {
+            *enabled = value->val != 0;
+            return (0);
+        }
+        *enabled = true;
+    }
+
+    if ((ret = wtext->config_parser_open(wtext, NULL, value->str, value->len, &parser)) != 0)
+        return (ret);
+    while ((ret = parser->next(parser, &k, &v)) == 0) {
+        for (key = keys; key->name != NULL && !JEB_CONFIG_MATCH(&k, key->name); key++)
+            ;
+        if (key->name == NULL) {
+            (void)wtext->err_printf(wtext, NULL, "unknown %s: %.*s", what, (int)k.len, k.str);
+            ret = EINVAL;
+            break;
+        }
+        field = (char *)&fs->cfg + key->off;
+        switch (key->type) {
+        case JEB_KEY_BOOL:
+            *(bool *)field = v.val != 0;
+            break;
+        case JEB_KEY_U32:
+            *(uint32_t *)field = (uint32_t)v.val;
+            break;
+        case JEB_KEY_U64:
+            *(uint64_t *)field = (uint64_t)v.val;
+            break;
+        case JEB_KEY_INT:
+            *(int *)field = (int)v.val;
+            break;
+        case JEB_KEY_FLAG:
+            *(uint32_t *)field |= key->flag;
+            break;
+        }
+    }
+    if (ret == WT_NOTFOUND)
+        ret = 0;
+    if ((tret = parser->close(parser)) != 0 && ret == 0)
+        ret = tret;
+    return (ret);
+}
+
+/* sqpoll=(enabled=true,idle_ms=120000,cpu=-1), or sqpoll=true|false */
+static int
+jeb_config_parse_sqpoll(JEB_FILE_SYSTEM *fs, WT_CONFIG_ITEM *value) {
+    static const JEB_CONFIG_KEY keys[] = {
+        JEB_KEY("enabled", JEB_KEY_BOOL, sqpoll),
+        JEB_KEY("idle_ms", JEB_KEY_U32, sqpoll_idle_ms),
+        JEB_KEY("cpu", JEB_KEY_INT, sqpoll_cpu),
+        JEB_KEY_END
+    };
+
+    return (jeb_config_parse_keys(fs, value, "sqpoll option", keys, &fs->cfg.sqpoll));
+}
+
+/* direct_io=[data,log] */
+static int
+jeb_config_parse_direct_io(JEB_FILE_SYSTEM *fs, WT_CONFIG_ITEM *value) {
+    static const JEB_CONFIG_KEY keys[] = {
+        { "data", JEB_KEY_FLAG, offsetof(JEB_CONFIG, direct_io), JEB_DIRECT_IO_DATA },
+        { "log", JEB_KEY_FLAG, offsetof(JEB_CONFIG, direct_io), JEB_DIRECT_IO_LOG },
+        JEB_KEY_END
+    };
+
+    fs->cfg.direct_io = 0;
+    if (value->len == 0)
+        return (0);
+    return (jeb_config_parse_keys(fs, value, "direct_io file type", keys, NULL));
+}
+
+/* stats=(enabled=true,log_wait=1), or stats=true */
+static int
+jeb_config_parse_stats(JEB_FILE_SYSTEM *fs, WT_CONFIG_ITEM *value) {
+    static const JEB_CONFIG_KEY keys[] = {
+        JEB_KEY("enabled", JEB_KEY_BOOL, stats),
+        JEB_KEY("log_wait", JEB_KEY_U32, stats_log_wait),
+        JEB_KEY_END
+    };
+
+    return (jeb_config_parse_keys(fs, value, "stats option", keys, &fs->cfg.stats));
+}
+
+/* trace=(enabled=true,records=4096,sample=1), or trace=true */
+static int
+jeb_config_parse_trace(JEB_FILE_SYSTEM *fs, WT_CONFIG_ITEM *value) {
+    static const JEB_CONFIG_KEY keys[] = {
+        JEB_KEY("enabled", JEB_KEY_BOOL, trace),
+        JEB_KEY("records", JEB_KEY_U32, trace_records),
+        JEB_KEY("sample", JEB_KEY_U32, trace_sample),
+        JEB_KEY_END
+    };
+
+    return (jeb_config_parse_keys(fs, value, "trace option", keys, &fs->cfg.trace));
+}
+
+/* submit_batch=(entries=8,window_us=20), or submit_batch=false */
+static int
+jeb_config_parse_submit_batch(JEB_FILE_SYSTEM *fs, WT_CONFIG_ITEM *value) {
+    static const JEB_CONFIG_KEY keys[] = {
+        JEB_KEY("entries", JEB_KEY_U32, batch_entries),
+        JEB_KEY("window_us", JEB_KEY_U32, batch_window_us),
+        JEB_KEY_END
+    };
+
+    if (value->type != WT_CONFIG_ITEM_STRUCT) {
+        fs->cfg.batch_entries = value->val != 0 ? SUBMIT_BATCH_ENTRIES : 0;
+        return (0);
+    }
+    return (jeb_config_parse_keys(fs, value, "submit_batch option", keys, NULL));
+}
+
+/* block_cache=(size=256MB,shards=16), or block_cache=<bytes> */
+static int
+jeb_config_parse_block_cache(JEB_FILE_SYSTEM *fs, WT_CONFIG_ITEM *value) {
+    static const JEB_CONFIG_KEY keys[] = {
+        JEB_KEY("size", JEB_KEY_U64, bcache_size),
+        JEB_KEY("shards", JEB_KEY_U32, bcache_shards),
+        JEB_KEY_END
+    };
+
+    if (value->type != WT_CONFIG_ITEM_STRUCT) {
+        fs->cfg.bcache_size = (uint64_t)value->val;
+        return (0);
+    }
+    return (jeb_config_parse_keys(fs, value, "block_cache option", keys, NULL));
+}
+
+/* prefetch_open=(files=4096,timeout_ms=60000), or prefetch_open=true|false */
+static int
+jeb_config_parse_prefetch_open(JEB_FILE_SYSTEM *fs, WT_CONFIG_ITEM *value) {
+    static const JEB_CONFIG_KEY keys[] = {
+        JEB_KEY("files", JEB_KEY_U32, prefetch_files),
+        JEB_KEY("timeout_ms", JEB_KEY_U32, prefetch_timeout_ms),
+        JEB_KEY_END
+    };
+
+    if (value->type != WT_CONFIG_ITEM_STRUCT) {
+        fs->cfg.prefetch_files = value->val != 0 ? PREFETCH_OPEN_FILES : 0;
+        return (0);
+    }
+    fs->cfg.prefetch_files = PREFETCH_OPEN_FILES;
+    return (jeb_config_parse_keys(fs, value, "prefetch_open option", keys, NULL));
+}
+
+/*
+* io_classes=(log_depth=0,read_depth=0,background_depth=8,log_ioprio=0,read_ioprio=2,
+* background_ioprio=6), or io_classes=true|false
+*/
+static int
+jeb_config_parse_io_classes(JEB_FILE_SYSTEM *fs, WT_CONFIG_ITEM *value) {
+    static const JEB_CONFIG_KEY keys[] = {
+        JEB_KEY("log_depth", JEB_KEY_U32, class_depth[JEB_CLASS_LOG]),
+        JEB_KEY("read_depth", JEB_KEY_U32, class_depth[JEB_CLASS_READ]),
+        JEB_KEY("background_depth", JEB_KEY_U32, class_depth[JEB_CLASS_BACKGROUND]),
+        JEB_KEY("log_ioprio", JEB_KEY_INT, class_ioprio[JEB_CLASS_LOG]),
+        JEB_KEY("read_ioprio", JEB_KEY_INT, class_ioprio[JEB_CLASS_READ]),
+        JEB_KEY("background_ioprio", JEB_KEY_INT, class_ioprio[JEB_CLASS_BACKGROUND]),
+        JEB_KEY_END
+    };
+
+    return (jeb_config_parse_keys(fs, value, "io_classes option", keys, &fs->cfg.io_classes));
+}
+
+/* admission=(min_depth=4,max_depth=64,target_us=1000), or admission=true|false */
+static int
+jeb_config_parse_admission(JEB_FILE_SYSTEM *fs, WT_CONFIG_ITEM *value) {
+    static const JEB_CONFIG_KEY keys[] = {
+        JEB_KEY("min_depth", JEB_KEY_U32, adm_min_depth),
+        JEB_KEY("max_depth", JEB_KEY_U32, adm_max_depth),
+        JEB_KEY("target_us", JEB_KEY_U32, adm_target_us),
+        JEB_KEY_END
+    };
+
+    return (jeb_config_parse_keys(fs, value, "admission option", keys, &fs->cfg.admission));
+}
+
+/* registered_buffers=(count=64,size=32KB) */
+static int
+jeb_config_parse_registered_buffers(JEB_FILE_SYSTEM *fs, WT_CONFIG_ITEM *value) {
+    static const JEB_CONFIG_KEY keys[] = {
+        JEB_KEY("count", JEB_KEY_U32, regbuf_count),
+        JEB_KEY("size", JEB_KEY_U64, regbuf_size),
+        JEB_KEY_END
+    };
+
+    if (value->type != WT_CONFIG_ITEM_STRUCT) {
+        // registered_buffers=N is a slot count; true picks the default count, false turns it off
+        if (value->type == WT_CONFIG_ITEM_BOOL)
+            fs->cfg.regbuf_count = value->val ? REGBUF_DEFAULT_COUNT : 0;
+        else
+            fs->cfg.regbuf_count = (uint32_t)value->val;
+        return (0);
+    }
+    return (jeb_config_parse_keys(fs, value, "registered_buffers option", keys, NULL));
+}
+
+/*
+* Fill in fs->cfg from the extension's config string, e.g.
+*
+*   extensions=[local={entry=create_custom_file_system,early_load=true,
+*       config=(queue_depth=64,rings=8,ring_topology=cpu,sqpoll=(enabled=true,idle_ms=2000,cpu=-1),
+*       cqe_batch=32,submitter_reap=false,iopoll=false,iopoll_spin=4096,direct_io=[data],registered_buffers=(count=64,size=32KB),
+*       registered_files=4096,submit_batch=(entries=8,window_us=20),stats=(enabled=true,log_wait=1),
+*       trace=(enabled=true,records=4096,sample=100),io_classes=(background_depth=8,background_ioprio=6),
+*       admission=(min_depth=4,max_depth=64,target_us=1000))}]
+*
+* Anything not mentioned keeps the defaults set below. config_str, when not NULL, is the
+* same thing as a plain string (the contents of config=(...)) and is used instead.
+*/
+static int
+jeb_config_parse(JEB_FILE_SYSTEM *fs, WT_CONFIG_ARG *config, const char *config_str) {
+    WT_CONFIG_ITEM k, v;
+    WT_CONFIG_PARSER *parser;
+    WT_EXTENSION_API *wtext;
+    int ret, tret;
+
+    wtext = fs->wtext;
+
+    fs->cfg.queue_depth = 16;
+    fs->cfg.rings = 0;
+    fs->cfg.ring_topology = RING_TOPOLOGY_CPU;
+    fs->cfg.sqpoll = true;
+    fs->cfg.sqpoll_idle_ms = 120000; // 2 minutes in ms;
+    fs->cfg.sqpoll_cpu = -1;
+    fs->cfg.iopoll = false;
+    fs->cfg.iopoll_spin = UD_SPIN_COUNT;
+    fs->cfg.cqe_batch = CQE_BATCH_SIZE;
+    fs->cfg.submitter_reap = false;
+    fs->cfg.batch_entries = 0;
+    fs->cfg.batch_window_us = SUBMIT_BATCH_WINDOW_US;
+    fs->cfg.stats = false;
+    fs->cfg.stats_log_wait = 0;
+    fs->cfg.trace = false;
+    fs->cfg.trace_records = TRACE_RECORDS_DEFAULT;
+    fs->cfg.trace_sample = 1;
+    fs->cfg.direct_io = 0;
+    fs->cfg.regbuf_count = 0;
+    fs->cfg.regbuf_size = 32 * 1024;
+    fs->cfg.regfiles = REGFILES_DEFAULT;
+    fs->cfg.chunk_size = CHUNK_SIZE_DEFAULT;
+    fs->cfg.group_commit = true;
+    fs->cfg.readahead = 0;
+    fs->cfg.write_combine = 0;
+    fs->cfg.bcache_size = 0;
+    fs->cfg.bcache_shards = JEB_BC_SHARDS;
+    fs->cfg.metadata_cache = true;
+    fs->cfg.prefetch_files = 0;
+    fs->cfg.prefetch_timeout_ms = PREFETCH_OPEN_TIMEOUT_MS;
+    fs->cfg.preallocate = 0;
+    fs->cfg.io_classes = false;
+    fs->cfg.class_depth[JEB_CLASS_LOG] = 0;
+    fs->cfg.class_depth[JEB_CLASS_READ] = 0;
+    fs->cfg.class_depth[JEB_CLASS_BACKGROUND] = JEB_CLASS_DEPTH_AUTO;
+    fs->cfg.class_ioprio[JEB_CLASS_LOG] = 0;
+    fs->cfg.class_ioprio[JEB_CLASS_READ] = 2;
+    fs->cfg.class_ioprio[JEB_CLASS_BACKGROUND] = 6;
+    fs->cfg.admission = false;
+    fs->cfg.adm_min_depth = ADMISSION_MIN_DEPTH;
+    fs->cfg.adm_max_depth = 0;
+    fs->cfg.adm_target_us = ADMISSION_TARGET_US;
+
+    if (config_str != NULL)
+        ret = wtext->config_parser_open(wtext, NULL, config_str, strlen(config_str), &parser);
+    else if (config != NULL)
+        ret = wtext->config_parser_open_arg(wtext, NULL, config, &parser);
+    else
+        return (0);
+    if (ret != 0) {
+        (void)wtext->err_printf(wtext, NULL, "WT_EXTENSION_API.config_parser_open_arg: %s",
+                wtext->strerror(wtext, NULL, ret));
+        return (ret);
+    }
+    while ((ret = parser->next(parser, &k, &v)) == 0) {
+        if (JEB_CONFIG_MATCH(&k, "queue_depth"))
+            fs->cfg.queue_depth = (uint32_t)v.val;
+        else if (JEB_CONFIG_MATCH(&k, "rings"))
+            fs->cfg.rings = (uint32_t)v.val;
+        else if (JEB_CONFIG_MATCH(&k, "ring_topology")) {
+            if (JEB_CONFIG_MATCH(&v, "cpu"))
+                fs->cfg.ring_topology = RING_TOPOLOGY_CPU;
+            else if (JEB_CONFIG_MATCH(&v, "numa"))
+                fs->cfg.ring_topology = RING_TOPOLOGY_NUMA;
+            else if (JEB_CONFIG_MATCH(&v, "session"))
+                fs->cfg.ring_topology = RING_TOPOLOGY_SESSION;
+            else {
+                (void)wtext->err_printf(wtext, NULL, "unknown ring_topology: %.*s", (int)v.len, v.str);
+                ret = EINVAL;
+            }
+        } else if (JEB_CONFIG_MATCH(&k, "sqpoll"))
+            ret = jeb_config_parse_sqpoll(fs, &v);
+        else if (JEB_CONFIG_MATCH(&k, "iopoll"))
+            fs->cfg.iopoll = v.val != 0;
+        else if (JEB_CONFIG_MATCH(&k, "iopoll_spin"))
+            fs->cfg.iopoll_spin = (uint32_t)v.val;
+        else if (JEB_CONFIG_MATCH(&k, "cqe_batch"))
+            fs->cfg.cqe_batch = (uint32_t)v.val;
+        else if (JEB_CONFIG_MATCH(&k, "submitter_reap"))
+            fs->cfg.submitter_reap = v.val != 0;
+        else if (JEB_CONFIG_MATCH(&k, "direct_io"))
+            ret = jeb_config_parse_direct_io(fs, &v);
+        else if (JEB_CONFIG_MATCH(&k, "registered_files"))
+            fs->cfg.regfiles = v.type == WT_CONFIG_ITEM_BOOL ? (v.val ? REGFILES_DEFAULT : 0) : (uint32_t)v.val;
+        else if (JEB_CONFIG_MATCH(&k, "registered_buffers"))
+            ret = jeb_config_parse_registered_buffers(fs, &v);
+        else if (JEB_CONFIG_MATCH(&k, "chunk_size"))
+            fs->cfg.chunk_size = (uint64_t)v.val;
+        else if (JEB_CONFIG_MATCH(&k, "group_commit"))
+            fs->cfg.group_commit = v.val != 0;
+        else if (JEB_CONFIG_MATCH(&k, "readahead"))
+            fs->cfg.readahead = (uint64_t)v.val;
+        else if (JEB_CONFIG_MATCH(&k, "write_combine"))
+            fs->cfg.write_combine = (uint64_t)v.val;
+        else if (JEB_CONFIG_MATCH(&k, "block_cache"))
+            ret = jeb_config_parse_block_cache(fs, &v);
+        else if (JEB_CONFIG_MATCH(&k, "metadata_cache"))
+            fs->cfg.metadata_cache = v.val != 0;
+        else if (JEB_CONFIG_MATCH(&k, "prefetch_open"))
+            ret = jeb_config_parse_prefetch_open(fs, &v);
+        else if (JEB_CONFIG_MATCH(&k, "preallocate"))
+            fs->cfg.preallocate = (uint64_t)v.val;
+        else if (JEB_CONFIG_MATCH(&k, "io_classes"))
+            ret = jeb_config_parse_io_classes(fs, &v);
+        else if (JEB_CONFIG_MATCH(&k, "admission"))
+            ret = jeb_config_parse_admission(fs, &v);
+        else if (JEB_CONFIG_MATCH(&k, "submit_batch"))
+            ret = jeb_config_parse_submit_batch(fs, &v);
+        else if (JEB_CONFIG_MATCH(&k, "stats"))
+            ret = jeb_config_parse_stats(fs, &v);
+        else if (JEB_CONFIG_MATCH(&k, "trace"))
+            ret = jeb_config_parse_trace(fs, &v);
+        else {
+            (void)wtext->err_printf(wtext, NULL, "unknown file system option: %.*s", (int)k.len, k.str);
+            ret = EINVAL;
+        }
+        if (ret != 0)
+            break;
+    }
+    if (ret == WT_NOTFOUND)
+        ret = 0;
+    if ((tret = parser->close(parser)) != 0 && ret == 0)
+        ret = tret;
+    if (ret != 0)
+        return (ret);
+
+    if (fs->cfg.queue_depth < QUEUE_DEPTH_MIN || fs->cfg.queue_depth > 32768) {
+        (void)wtext->err_printf(wtext, NULL, "queue_depth must be between %d and 32768", QUEUE_DEPTH_MIN);
+        return (EINVAL);
+    }
+    if (fs->cfg.cqe_batch == 0 || fs->cfg.cqe_batch > CQE_BATCH_MAX) {
+        (void)wtext->err_printf(wtext, NULL, "cqe_batch must be between 1 and %d", CQE_BATCH_MAX);
+        return (EINVAL);
+    }
+#ifdef JEB_NO_TRACE
+    if (fs->cfg.trace) {
+        (void)wtext->err_printf(wtext, NULL, "tracing was compiled out (JEB_NO_TRACE), ignoring trace");
+        fs->cfg.trace = false;
+    }
+#endif
+    if (fs->cfg.trace_records == 0 || (fs->cfg.trace_records & (fs->cfg.trace_records - 1)) != 0 ||
+      fs->cfg.trace_sample == 0) {
+        (void)wtext->err_printf(wtext, NULL,
+          "trace records must be a power of two and sample at least 1");
+        return (EINVAL);
+    }
+    // a batch bigger than the SQ would never fill, every leader would sit out the whole window
+    if (fs->cfg.batch_entries > fs->cfg.queue_depth) {
+        (void)wtext->err_printf(wtext, NULL, "submit_batch entries can't be more than queue_depth (%u)",
+          fs->cfg.queue_depth);
+        return (EINVAL);
+    }
+
+    // IOPOLL only works for O_DIRECT, everything else stays on the eventfd rings
+    if (fs->cfg.iopoll && fs->cfg.direct_io == 0)
+        (void)wtext->err_printf(wtext, NULL,
+          "iopoll only applies to O_DIRECT files, and direct_io isn't configured");
+    // chunk boundaries have to stay aligned for O_DIRECT
+    if (fs->cfg.chunk_size % DIO_DEFAULT_ALIGN != 0 || fs->cfg.chunk_size > JEB_CHUNK_LIMIT) {
+        (void)wtext->err_printf(wtext, NULL,
+          "chunk_size must be a multiple of %d and at most 1GB", DIO_DEFAULT_ALIGN);
+        return (EINVAL);
+    }
+    if (fs->cfg.readahead % DIO_DEFAULT_ALIGN != 0 || fs->cfg.readahead > JEB_RA_MAX) {
+        (void)wtext->err_printf(wtext, NULL,
+          "readahead must be a multiple of %d and at most 64MB", DIO_DEFAULT_ALIGN);
+        return (EINVAL);
+    }
+    if (fs->cfg.write_combine % DIO_DEFAULT_ALIGN != 0 || fs->cfg.write_combine > JEB_WC_MAX) {
+        (void)wtext->err_printf(wtext, NULL,
+          "write_combine must be a multiple of %d and at most 64MB", DIO_DEFAULT_ALIGN);
+        return (EINVAL);
+    }
+    if (fs->cfg.bcache_size != 0 && (fs->cfg.bcache_shards == 0 || fs->cfg.bcache_shards > 1024)) {
+        (void)wtext->err_printf(wtext, NULL, "block_cache shards must be between 1 and 1024");
+        return (EINVAL);
+    }
+    if (fs->cfg.prefetch_files != 0 && fs->cfg.prefetch_timeout_ms == 0) {
+        (void)wtext->err_printf(wtext, NULL, "prefetch_open timeout_ms must be non-zero");
+        return (EINVAL);
+    }
+    if (fs->cfg.regbuf_count != 0 && fs->cfg.regbuf_size == 0) {
+        (void)wtext->err_printf(wtext, NULL, "registered_buffers size must be non-zero");
+        return (EINVAL);
+    }
+    // with io_classes off every class is unlimited, and the ioprio is never looked at
+    for (int cls = 0; cls < JEB_CLASSES; cls++) {
+        if (!fs->cfg.io_classes) {
+            fs->cfg.class_depth[cls] = 0;
+            continue;
+        }
+        if (fs->cfg.class_depth[cls] == JEB_CLASS_DEPTH_AUTO)
+            fs->cfg.class_depth[cls] = fs->cfg.queue_depth > 1 ? fs->cfg.queue_depth / 2 : 1;
+        if (fs->cfg.class_ioprio[cls] < -1 || fs->cfg.class_ioprio[cls] > 7) {
+            (void)wtext->err_printf(wtext, NULL, "io_classes ioprio must be between -1 and 7");
+            return (EINVAL);
+        }
+    }
+    // the window can't usefully go past what the CQ holds (twice the SQ)
+    if (fs->cfg.admission) {
+        if (fs->cfg.adm_max_depth == 0)
+            fs->cfg.adm_max_depth = fs->cfg.queue_depth;
+        if (fs->cfg.adm_max_depth > 2 * fs->cfg.queue_depth || fs->cfg.adm_min_depth == 0 ||
+          fs->cfg.adm_target_us == 0) {
+            (void)wtext->err_printf(wtext, NULL,
+              "admission needs min_depth and target_us non-zero, and max_depth at most twice queue_depth");
+            return (EINVAL);
+        }
+        if (fs->cfg.adm_min_depth > fs->cfg.adm_max_depth)
+            fs->cfg.adm_min_depth = fs->cfg.adm_max_depth;
     }
-
-    return (NULL);
+    return (0);
 }
 
 /*
-* Initialization function for the custom file system/handle.
+* Build the file system from either form of the config, without installing it anywhere.
 */
-int create_custom_file_system(WT_CONNECTION *conn, WT_CONFIG_ARG *config) {
+static int
+jeb_file_system_create(WT_CONNECTION *conn, WT_CONFIG_ARG *config, const char *config_str,
+    WT_FILE_SYSTEM **file_systemp) {
     JEB_FILE_SYSTEM *fs;
     WT_EXTENSION_API *wtext;
     WT_FILE_SYSTEM *file_system;
     // struct io_uring *ring = NULL;
     int ret = 0;
-    int efd;
 
     wtext = conn->get_extension_api(conn);
 
@@ -217,10 +4507,19 @@ int create_custom_file_system(WT_CONNECTION *conn, WT_CONFIG_ARG *config) {
     }
 
     fs->wtext = wtext;
+    fs->id = __atomic_add_fetch(&jeb_fs_next_id, 1, __ATOMIC_RELAXED);
     file_system = (WT_FILE_SYSTEM *)fs;
+    pthread_mutex_init(&fs->dirfd_lock, NULL);
+    pthread_mutex_init(&fs->dents_lock, NULL);
+
+    if ((ret = jeb_ud_pool_init(fs)) != 0) {
+        (void)wtext->err_printf(wtext, NULL, "failed to allocate completion slots: %s",
+                wtext->strerror(wtext, NULL, ret));
+        goto err;
+    }
 
-    // NOTE: this is where we can parse the config string to set values into the custom FS,
-    // but I'm omitting for now (not sure if i need ....)
+    if ((ret = jeb_config_parse(fs, config, config_str)) != 0)
+        goto err;
 
     file_system->fs_directory_list = jeb_fs_directory_list;
     file_system->fs_directory_list_free = jeb_fs_directory_list_free;
@@ -230,57 +4529,123 @@ int create_custom_file_system(WT_CONNECTION *conn, WT_CONFIG_ARG *config) {
     file_system->fs_rename = jeb_fs_rename;
     file_system->fs_size = jeb_fs_size;
     file_system->terminate = jeb_fs_terminate;
+    if (fs->cfg.stats || fs->cfg.trace) {
+        file_system->fs_exist = jeb_fs_exist_timed;
+        file_system->fs_open_file = jeb_fs_open_timed;
+        file_system->fs_remove = jeb_fs_remove_timed;
+        file_system->fs_rename = jeb_fs_rename_timed;
+        file_system->fs_size = jeb_fs_size_timed;
+    }
 
-    // now, set up the uring
-    efd = eventfd(0, 0);
-    if (efd < 0) {
-        (void)wtext->err_printf(wtext, NULL, "failed to create eventfd: %s",
-                wtext->strerror(wtext, NULL, efd));
-        free(fs);
-        exit (1);
+    if ((ret = jeb_bufpool_init(&fs->regbufs, fs->cfg.regbuf_count, fs->cfg.regbuf_size)) != 0) {
+        (void)wtext->err_printf(wtext, NULL, "failed to allocate registered buffers: %s",
+                wtext->strerror(wtext, NULL, ret));
+        goto err;
     }
-    fs->efd = efd;
-    if ((ret = init_io_uring(&fs->ring, efd)) != 0) {
-        (void)wtext->err_printf(wtext, NULL, "failed to create uring: %s",
+
+    if (fs->cfg.regfiles != 0) {
+        if ((ret = jeb_freelist_init(&fs->file_slots, fs->cfg.regfiles)) != 0)
+            goto err;
+        fs->nfile_slots = fs->cfg.regfiles;
+    }
+
+    if (fs->cfg.direct_io != 0 &&
+      (ret = jeb_bufpool_init(&fs->bounce, BOUNCE_POOL_COUNT, BOUNCE_POOL_SIZE)) != 0) {
+        (void)wtext->err_printf(wtext, NULL, "failed to allocate direct I/O bounce buffers: %s",
+                wtext->strerror(wtext, NULL, ret));
+        goto err;
+    }
+
+    if (fs->cfg.metadata_cache && (ret = jeb_meta_init(fs)) != 0) {
+        (void)wtext->err_printf(wtext, NULL, "failed to allocate the metadata cache: %s",
+                wtext->strerror(wtext, NULL, ret));
+        goto err;
+    }
+
+    if (fs->cfg.bcache_size != 0 && (ret = jeb_bcache_init(fs)) != 0) {
+        (void)wtext->err_printf(wtext, NULL, "failed to allocate the block cache: %s",
                 wtext->strerror(wtext, NULL, ret));
-        free(fs);
-        exit(1);
+        goto err;
     }
 
-    if ((ret = pthread_create(&fs->uring_consumer, NULL, ring_consumer, (void *)fs)) != 0) {
+    // now, set up the urings
+    if ((ret = jeb_rings_init(fs)) != 0) {
         (void)wtext->err_printf(wtext, NULL, "failed to create uring: %s",
                 wtext->strerror(wtext, NULL, ret));
-        // TODO: probably need better clean up code, esp after init'ing the uring
-        free(fs);
-        exit(1);
+        goto err;
     }
 
-    printf("JEB::create_custom_file_system about to set FS into the connection\n");
+    // opens just aren't prefetched without it
+    if (fs->cfg.prefetch_files != 0 && (ret = jeb_pf_init(fs)) != 0)
+        (void)wtext->err_printf(wtext, NULL, "failed to start open prefetching: %s",
+                wtext->strerror(wtext, NULL, ret));
+
+    // the numbers still get collected and dumped without the log thread, so don't fail over it
+    if (fs->cfg.stats && (ret = jeb_stats_init(fs, conn)) != 0)
+        (void)wtext->err_printf(wtext, NULL, "failed to start the stats log: %s",
+                wtext->strerror(wtext, NULL, ret));
+#ifndef JEB_NO_TRACE
+    if (fs->cfg.trace && (ret = jeb_trace_init(fs, conn)) != 0)
+        (void)wtext->err_printf(wtext, NULL, "failed to set up the trace file: %s",
+                wtext->strerror(wtext, NULL, ret));
+#endif
+
+    *file_systemp = file_system;
+    return (0);
+
+err:
+    // the destroys all cope with never having been initialized
+    jeb_bcache_destroy(fs);
+    jeb_meta_destroy(fs);
+    jeb_bufpool_destroy(&fs->bounce);
+    jeb_freelist_destroy(&fs->file_slots);
+    jeb_bufpool_destroy(&fs->regbufs);
+    jeb_ud_pool_destroy(fs);
+    pthread_mutex_destroy(&fs->dents_lock);
+    pthread_mutex_destroy(&fs->dirfd_lock);
+    free(fs);
+    return (ret);
+}
+
+/*
+* Initialization function for the custom file system/handle.
+*/
+int create_custom_file_system(WT_CONNECTION *conn, WT_CONFIG_ARG *config) {
+    WT_EXTENSION_API *wtext;
+    WT_FILE_SYSTEM *file_system;
+    int ret;
+
+    if ((ret = jeb_file_system_create(conn, config, NULL, &file_system)) != 0)
+        return (ret);
+
     if ((ret = conn->set_file_system(conn, file_system, NULL)) != 0) {
+        wtext = conn->get_extension_api(conn);
         (void)wtext->err_printf(wtext, NULL, "WT_CONNECTION.set_file_system: %s", 
                 wtext->strerror(wtext, NULL, ret));
-        free(fs);
-        exit(1);
+        // the rings and their threads are up by now, so it takes a full teardown
+        (void)file_system->terminate(file_system, NULL);
+        return (ret);
     }
 
-    printf("JEB::create_custom_file_system successfully set up custom file system!\n");
     return (0);
 }
 
+int
+wt_uring_file_system_create(WT_CONNECTION *conn, const char *config, WT_FILE_SYSTEM **file_systemp) {
+    return (jeb_file_system_create(conn, NULL, config != NULL ? config : "", file_systemp));
+}
+
 static int 
 jeb_fs_open(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name , 
     WT_FS_OPEN_FILE_TYPE file_type, uint32_t flags , WT_FILE_HANDLE **file_handlep) {
     JEB_FILE_HANDLE *jeb_file_handle;
     JEB_FILE_SYSTEM *jeb_fs;
+    JEB_RING *ring;
     WT_FILE_HANDLE *file_handle;
     struct io_uring_sqe *sqe;
     int ret = 0;
     int open_flags = 0, fd = 0, mode = 0;
-
-    printf("JEB::jeb_fs_open %s\n", name);
-
-    (void)flags; /* ignored for now */
-    (void)file_type; /* unused */
+    bool direct_io, group_commit;
 
     *file_handlep = NULL;
     jeb_fs = (JEB_FILE_SYSTEM *)fs;
@@ -295,7 +4660,7 @@ jeb_fs_open(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name ,
         open_flags |= O_CLOEXEC;
         if (flags & WT_FS_OPEN_CREATE) {
             open_flags |= O_CREAT;
-            if (flags | WT_FS_OPEN_EXCLUSIVE) 
+            if (flags & WT_FS_OPEN_EXCLUSIVE) 
                 open_flags |= O_EXCL;
             mode = 0644;
         } else {
@@ -305,55 +4670,98 @@ jeb_fs_open(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name ,
 
     // NOTE: WT sets the O_DSYNC flag on log (WAL) files. not sure if that's totally cool with io_uring,
     // but I didn't look very hard: https://lore.kernel.org/all/CAF-ewDoqyx5knsnd_qgfRXE+CxK==PO1zF+RE=oEuv9NQq+48g@mail.gmail.com/T/
+    // with group_commit on we skip it, and durable log writes get their own linked fdatasync
+    // instead (see jeb_fh_commit_write()). a chain needs at least two SQ entries.
+    group_commit = file_type == WT_FS_OPEN_FILE_TYPE_LOG && (flags & WT_FS_OPEN_DURABLE) &&
+      jeb_fs->cfg.group_commit && jeb_fs->cfg.queue_depth >= 2;
+    if (file_type == WT_FS_OPEN_FILE_TYPE_LOG && (flags & WT_FS_OPEN_DURABLE) && !group_commit)
+        open_flags |= O_DSYNC;
+
+    // O_DIRECT for the file types picked by direct_io=[data,log], or when WT asks for it itself.
+    // it's switched on after the open: a file system that can't do O_DIRECT (tmpfs, say)
+    // only says so once openat has already created the file, and an O_EXCL retry would fail
+    direct_io = (flags & WT_FS_OPEN_DIRECTIO) ||
+      (file_type == WT_FS_OPEN_FILE_TYPE_DATA && (jeb_fs->cfg.direct_io & JEB_DIRECT_IO_DATA)) ||
+      (file_type == WT_FS_OPEN_FILE_TYPE_LOG && (jeb_fs->cfg.direct_io & JEB_DIRECT_IO_LOG));
+
+    // a directory listing may have had it opened already
+    fd = -1;
+    if (jeb_fs->pf != NULL && file_type == WT_FS_OPEN_FILE_TYPE_DATA)
+        fd = jeb_pf_claim(jeb_fs, name, open_flags);
 
-    sqe = io_uring_get_sqe(&jeb_fs->ring);
-    io_uring_prep_openat(sqe, 0, name, open_flags, mode);
-    RING_EVENT_USER_DATA *ud = malloc(sizeof(RING_EVENT_USER_DATA));
-    ud->event_type = EVENT_TYPE_NORMAL;
-    
-    /* Initialize mutex and condition variable objects */
-    pthread_mutex_init(&ud->mutex, NULL);
-    pthread_cond_init (&ud->condvar, NULL);
-    pthread_mutex_lock(&ud->mutex);
-
-    io_uring_sqe_set_data(sqe, ud);
-    io_uring_submit(&jeb_fs->ring);
-    
-    // this should be in a loop to deal with spurious wakeups.
-    // should probably use pthread_cond_timedwait().
-    pthread_cond_wait(&ud->condvar, &ud->mutex);
-    pthread_mutex_unlock(&ud->mutex);
-    pthread_mutex_destroy(&ud->mutex);
-    pthread_cond_destroy(&ud->condvar);
-
-    fd = ud->ret_code;
-    free(ud);
+    if (fd < 0) {
+        ring = jeb_ring_select(jeb_fs, session);
+        sqe = jeb_ring_get_sqe(ring);
+        io_uring_prep_openat(sqe, AT_FDCWD, name, open_flags, mode);
+        fd = jeb_ring_submit_and_wait(ring, sqe, EVENT_TYPE_NORMAL);
+    }
 
     if (fd < 0) {
+        ret = -fd;
         fprintf(stderr, "failed to create a new file: %s, err: %s\n", name, strerror(ret));
         return ret;
     }
 
-    // WT does some fadvise stuff, as well. ignoring for now
+    // EINVAL is the file system not doing O_DIRECT; use the page cache
+    if (direct_io) {
+        if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_DIRECT) == 0)
+            open_flags |= O_DIRECT;
+        else if (errno == EINVAL)
+            direct_io = false;
+        else {
+            ret = errno;
+            fprintf(stderr, "failed to set O_DIRECT on %s, err: %s\n", name, strerror(ret));
+            goto err;
+        }
+    }
 
     if ((jeb_file_handle = calloc(1, sizeof(JEB_FILE_HANDLE))) == NULL) {
         ret = ENOMEM;
-        // goto err?????
+        goto err;
+    }
+    file_handle = (WT_FILE_HANDLE *)jeb_file_handle;
+    if ((file_handle->name = strdup(name)) == NULL) {
+        ret = ENOMEM;
+        goto err;
     }
 
     jeb_file_handle->fs = jeb_fs;
     jeb_file_handle->fd = fd;
+    jeb_file_handle->file_id = __atomic_add_fetch(&jeb_fs->next_file_id, 1, __ATOMIC_RELAXED);
+    jeb_file_handle->open_flags = open_flags;
+    jeb_file_handle->direct_io = direct_io;
+    jeb_file_handle->buffered_fd = -1;
+    pthread_mutex_init(&jeb_file_handle->flush_lock, NULL);
+    pthread_mutex_init(&jeb_file_handle->extend_lock, NULL);
+    jeb_file_handle->extend_end = -1;
+    jeb_file_handle->group_commit = group_commit;
+    jeb_file_handle->log_file = file_type == WT_FS_OPEN_FILE_TYPE_LOG;
+    pthread_mutex_init(&jeb_file_handle->commit_lock, NULL);
+    jeb_file_handle->commit_tailp = &jeb_file_handle->commit_head;
+    pthread_mutex_init(&jeb_file_handle->map_lock, NULL);
+    pthread_mutex_init(&jeb_file_handle->ra_lock, NULL);
+    // log files need their writes on disk in order and on time, O_DIRECT would need the
+    // runs aligned; neither is worth staging
+    jeb_file_handle->wc_enabled = jeb_fs->cfg.write_combine != 0 &&
+      file_type == WT_FS_OPEN_FILE_TYPE_DATA && !direct_io && !(flags & WT_FS_OPEN_READONLY);
+    pthread_mutex_init(&jeb_file_handle->wc_lock, NULL);
+    if (direct_io)
+        jeb_fh_dio_align(jeb_file_handle);
+    jeb_fh_register_file(jeb_file_handle);
+
+    // pass along the access pattern hint like WT's posix layer does; the page cache
+    // doesn't matter with O_DIRECT
+    if (!direct_io && file_type == WT_FS_OPEN_FILE_TYPE_DATA &&
+      (flags & (WT_FS_OPEN_ACCESS_RAND | WT_FS_OPEN_ACCESS_SEQ)))
+        jeb_fh_fadvise_nowait(jeb_file_handle, session, 0, 0,
+          flags & WT_FS_OPEN_ACCESS_SEQ ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_RANDOM);
 
-    file_handle = (WT_FILE_HANDLE *)jeb_file_handle;
     file_handle->file_system = fs;
-    if ((file_handle->name = strdup(name)) == NULL) {
-        ret = ENOMEM;
-        // goto err;
-    }
+    if (jeb_fs->meta != NULL && file_type != WT_FS_OPEN_FILE_TYPE_DIRECTORY)
+        jeb_meta_opened(jeb_file_handle);
 
-    // TODO: when we support mmap, update the function pointers below
     file_handle->close = jeb_fh_close;
-    file_handle->fh_advise = NULL;
+    file_handle->fh_advise = jeb_fh_advise;
     file_handle->fh_extend = jeb_fh_extend;
     file_handle->fh_extend_nolock = jeb_fh_extend_nolock;
     file_handle->fh_lock = jeb_fh_lock;
@@ -367,9 +4775,28 @@ jeb_fs_open(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name ,
     file_handle->fh_truncate = jeb_fh_truncate;
     file_handle->fh_unmap = jeb_fh_unmap;
     file_handle->fh_write = jeb_fh_write;
+    if (jeb_fs->cfg.stats || jeb_fs->cfg.trace) {
+        jeb_file_handle->stat_ftype = jeb_stat_ftype(file_type);
+        file_handle->close = jeb_fh_close_timed;
+        file_handle->fh_extend = jeb_fh_extend_timed;
+        file_handle->fh_extend_nolock = jeb_fh_extend_timed;
+        file_handle->fh_read = jeb_fh_read_timed;
+        file_handle->fh_size = jeb_fh_size_timed;
+        file_handle->fh_sync = jeb_fh_sync_timed;
+        file_handle->fh_sync_nowait = jeb_fh_sync_nowait_timed;
+        file_handle->fh_truncate = jeb_fh_truncate_timed;
+        file_handle->fh_write = jeb_fh_write_timed;
+    }
 
     *file_handlep = file_handle;
+    return (0);
 
+err:
+    if (jeb_file_handle != NULL) {
+        free(jeb_file_handle->iface.name);
+        free(jeb_file_handle);
+    }
+    (void)close(fd);
     return (ret);
 }
 
@@ -377,62 +4804,77 @@ jeb_fs_open(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name ,
 static int 
 jeb_fs_exist(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name, bool *existp) {
     JEB_FILE_SYSTEM *jeb_fs;
+    JEB_RING *ring;
     struct statx statx;
     struct io_uring_sqe *sqe;
+    uint64_t gen = 0;
     int ret = 0;
 
     jeb_fs = (JEB_FILE_SYSTEM *)fs;
-    sqe = io_uring_get_sqe(&jeb_fs->ring);
-    io_uring_prep_statx(sqe, 0, name, 0, 0, &statx);
-    RING_EVENT_USER_DATA *ud = malloc(sizeof(RING_EVENT_USER_DATA));
-    ud->event_type = EVENT_TYPE_NORMAL;
-    
-    /* Initialize mutex and condition variable objects */
-    pthread_mutex_init(&ud->mutex, NULL);
-    pthread_cond_init (&ud->condvar, NULL);
-    pthread_mutex_lock(&ud->mutex);
-
-    io_uring_sqe_set_data(sqe, ud);
-    io_uring_submit(&jeb_fs->ring);
-
-    // this should be in a loop to deal with spurious wakeups.
-    // should probably use pthread_cond_timedwait().
-    pthread_cond_wait(&ud->condvar, &ud->mutex);
-    pthread_mutex_unlock(&ud->mutex);
-    pthread_mutex_destroy(&ud->mutex);
-    pthread_cond_destroy(&ud->condvar);
-    ret = ud->ret_code;
+    if (jeb_fs->meta != NULL && jeb_meta_lookup(jeb_fs, name, existp, NULL, &ret, &gen))
+        return (0);
 
-    free(ud);
+    // ask for the size too, so a later fs_size of the same name is a hit
+    ring = jeb_ring_select(jeb_fs, session);
+    sqe = jeb_ring_get_sqe(ring);
+    io_uring_prep_statx(sqe, AT_FDCWD, name, 0, STATX_SIZE, &statx);
+    ret = jeb_ring_submit_and_wait(ring, sqe, EVENT_TYPE_NORMAL);
     if (ret == 0) {
+        if (jeb_fs->meta != NULL)
+            jeb_meta_store(jeb_fs, name, true, (wt_off_t)statx.stx_size, gen);
         *existp = true;
         return (0);
     }
     if (-ret == ENOENT) {
+        if (jeb_fs->meta != NULL)
+            jeb_meta_store(jeb_fs, name, false, -1, gen);
         *existp = false;
         return (0);
     }
 
-    return ret;
+    return (-ret);
 }
 
 /* POSIX remove */
 static int 
 jeb_fs_remove(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name, uint32_t flags) {
-    // io_uring doesn't support unlink(), so copying WT's __posix_fs_remove().
-    // NOTE: completely ignoring that we'd need to flush the parent directory(ies), as well,
-    // cuz this is PoC.
-
-    printf("JEB::jeb_fs_remove %s\n", name);
+    // unlinkat through the ring. with WT_FS_DURABLE it's linked to an fsync of the parent
+    // directory, so the remove is durable when this returns (WT's posix layer does the same
+    // with a separate __posix_directory_sync()).
+    JEB_FILE_SYSTEM *jeb_fs;
+    JEB_RING *ring;
+    struct io_uring_sqe *sqes[2];
+    char dir[PATH_MAX];
+    const char *base;
+    int dirfd, res[2];
     int ret = 0;
+    bool cached;
 
-    /*
-     * ISO C doesn't require rename return -1 on failure or set errno (note POSIX 1003.1 extends C
-     * with those requirements). Be cautious, force any non-zero return to -1 so we'll check errno.
-     * We can still end up with the wrong errno (if errno is garbage), or the generic WT_ERROR
-     * return (if errno is 0), but we've done the best we can.
-     */
-    if ((ret = unlink(name)) != 0) {
+    jeb_fs = (JEB_FILE_SYSTEM *)fs;
+    ring = jeb_ring_select(jeb_fs, session);
+
+    if (!(flags & WT_FS_DURABLE)) {
+        sqes[0] = jeb_ring_get_sqe(ring);
+        io_uring_prep_unlinkat(sqes[0], AT_FDCWD, name, 0);
+        ret = -jeb_ring_submit_and_wait(ring, sqes[0], EVENT_TYPE_NORMAL);
+    } else if ((ret = jeb_path_split(name, dir, sizeof(dir), &base)) == 0) {
+        if ((dirfd = jeb_dirfd_get(jeb_fs, dir, &cached)) < 0)
+            ret = -dirfd;
+        else {
+            jeb_ring_get_sqes(ring, sqes, 2);
+            io_uring_prep_unlinkat(sqes[0], dirfd, base, 0);
+            io_uring_prep_fsync(sqes[1], dirfd, 0);
+            jeb_ring_submit_chain_and_wait(ring, sqes, 2, res);
+            ret = res[0] < 0 ? -res[0] : (res[1] < 0 ? -res[1] : 0);
+            if (!cached)
+                (void)close(dirfd);
+        }
+    }
+    // even a failed remove may have happened
+    jeb_meta_invalidate(jeb_fs, name);
+    jeb_pf_invalidate(jeb_fs, name);
+
+    if (ret != 0) {
         fprintf(stderr, "failed remove (delete) %s, err: %s\n", name, strerror(ret));
         return ret;
     }
@@ -441,19 +4883,65 @@ jeb_fs_remove(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name, uint32_
 
 static int 
 jeb_fs_rename(WT_FILE_SYSTEM *fs , WT_SESSION *session, const char *from, const char *to, uint32_t flags) {
+    // renameat through the ring; with WT_FS_DURABLE it's linked to fsyncs of the target's
+    // directory and, if it's a different one, the source's.
+    JEB_FILE_SYSTEM *jeb_fs;
+    JEB_RING *ring;
+    struct io_uring_sqe *sqes[3];
+    char from_dir[PATH_MAX], to_dir[PATH_MAX];
+    const char *from_base, *to_base;
+    int from_fd, to_fd, res[3];
+    uint32_t n;
     int ret = 0;
-    
-    printf("JEB::jeb_fs_rename - from: %s => %s\n", from, to);
-    // io_uring doesn't support rename(), so copying WT's __posix_fs_rename().
-    // NOTE: completely ignoring that we'd need to flush the parent directory(ies), as well,
-    // cuz this is PoC.
-    /*
-     * ISO C doesn't require rename return -1 on failure or set errno (note POSIX 1003.1 extends C
-     * with those requirements). Be cautious, force any non-zero return to -1 so we'll check errno.
-     * We can still end up with the wrong errno (if errno is garbage), or the generic WT_ERROR
-     * return (if errno is 0), but we've done the best we can.
-     */
-    if ((ret = rename(from, to)) != 0) {
+    bool from_cached, to_cached;
+
+    jeb_fs = (JEB_FILE_SYSTEM *)fs;
+    ring = jeb_ring_select(jeb_fs, session);
+
+    if (!(flags & WT_FS_DURABLE)) {
+        sqes[0] = jeb_ring_get_sqe(ring);
+        io_uring_prep_renameat(sqes[0], AT_FDCWD, from, AT_FDCWD, to, 0);
+        ret = -jeb_ring_submit_and_wait(ring, sqes[0], EVENT_TYPE_NORMAL);
+        goto done;
+    }
+
+    if ((ret = jeb_path_split(from, from_dir, sizeof(from_dir), &from_base)) != 0 ||
+      (ret = jeb_path_split(to, to_dir, sizeof(to_dir), &to_base)) != 0)
+        goto done;
+    if ((to_fd = jeb_dirfd_get(jeb_fs, to_dir, &to_cached)) < 0) {
+        ret = -to_fd;
+        goto done;
+    }
+    if (strcmp(from_dir, to_dir) == 0) {
+        from_fd = to_fd;
+        from_cached = true;
+    } else if ((from_fd = jeb_dirfd_get(jeb_fs, from_dir, &from_cached)) < 0) {
+        ret = -from_fd;
+        goto close_dirs;
+    }
+
+    n = from_fd == to_fd ? 2 : 3;
+    jeb_ring_get_sqes(ring, sqes, n);
+    io_uring_prep_renameat(sqes[0], from_fd, from_base, to_fd, to_base, 0);
+    io_uring_prep_fsync(sqes[1], to_fd, 0);
+    if (n == 3)
+        io_uring_prep_fsync(sqes[2], from_fd, 0);
+    jeb_ring_submit_chain_and_wait(ring, sqes, n, res);
+    for (uint32_t i = 0; i < n && ret == 0; i++)
+        if (res[i] < 0)
+            ret = -res[i];
+
+    if (!from_cached)
+        (void)close(from_fd);
+close_dirs:
+    if (!to_cached)
+        (void)close(to_fd);
+done:
+    jeb_meta_invalidate(jeb_fs, from);
+    jeb_meta_invalidate(jeb_fs, to);
+    jeb_pf_invalidate(jeb_fs, from);
+    jeb_pf_invalidate(jeb_fs, to);
+    if (ret != 0) {
         fprintf(stderr, "failed rename %s to %s, err: %s\n", from, to, strerror(ret));
         return ret;
     }
@@ -465,127 +4953,147 @@ static int
 jeb_fs_size(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name, wt_off_t *sizep) {
     // NOTE: almost exactly the same as jeb_fh_size() - only diff is args to stax()
     JEB_FILE_SYSTEM *jeb_fs;
+    JEB_RING *ring;
     struct statx statx;
     struct io_uring_sqe *sqe;
+    uint64_t gen = 0;
     int ret = 0;
 
-    printf("JEB::jeb_fs_size %s\n", name);
     jeb_fs = (JEB_FILE_SYSTEM *)fs;
-    sqe = io_uring_get_sqe(&jeb_fs->ring);
-    io_uring_prep_statx(sqe, 0, name, 0, 0, &statx);
-    RING_EVENT_USER_DATA *ud = malloc(sizeof(RING_EVENT_USER_DATA));
-    ud->event_type = EVENT_TYPE_NORMAL;
-    
-    /* Initialize mutex and condition variable objects */
-    pthread_mutex_init(&ud->mutex, NULL);
-    pthread_cond_init (&ud->condvar, NULL);
-    pthread_mutex_lock(&ud->mutex);
-
-    io_uring_sqe_set_data(sqe, ud);
-    io_uring_submit(&jeb_fs->ring);
+    if (jeb_fs->meta != NULL && jeb_meta_lookup(jeb_fs, name, NULL, sizep, &ret, &gen))
+        return (ret);
 
-    // this should be in a loop to deal with spurious wakeups.
-    // should probably use pthread_cond_timedwait().
-    pthread_cond_wait(&ud->condvar, &ud->mutex);
-    pthread_mutex_unlock(&ud->mutex);
-    pthread_mutex_destroy(&ud->mutex);
-    pthread_cond_destroy(&ud->condvar);
-    ret = ud->ret_code;
-
-    free(ud);
+    ring = jeb_ring_select(jeb_fs, session);
+    sqe = jeb_ring_get_sqe(ring);
+    io_uring_prep_statx(sqe, AT_FDCWD, name, 0, STATX_SIZE, &statx);
+    ret = jeb_ring_submit_and_wait(ring, sqe, EVENT_TYPE_NORMAL);
     if (ret == 0) {
+        if (jeb_fs->meta != NULL)
+            jeb_meta_store(jeb_fs, name, true, (wt_off_t)statx.stx_size, gen);
         *sizep = statx.stx_size;
         return (0);
     }
+    if (ret == -ENOENT && jeb_fs->meta != NULL)
+        jeb_meta_store(jeb_fs, name, false, -1, gen);
 
-    return ret;
+    return (-ret);
 }
 
 /* Check if a string matches a prefix. */
 #define JEB_PREFIX_MATCH(str, pfx) \
     (((const char *)(str))[0] == ((const char *)(pfx))[0] && strncmp(str, pfx, strlen(pfx)) == 0)
 
+/* the record layout getdents64() fills in */
+struct jeb_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
 /* return a list of files in a given sub-directory */
 static int 
 jeb_fs_directory_list(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *directory, 
     const char *prefix, char ***dirlistp, uint32_t *countp) {
-    // io_uring doesn't support syscalls to list a directory.
-    // thus, copying WT's__directory_list_worker()
-
-    struct dirent *dp;
-    DIR *dirp;
-    // size_t dirallocsz;
+    // io_uring doesn't support syscalls to list a directory (no getdents op), so this is
+    // WT's __directory_list_worker() on top of raw getdents64(), with a reused buffer
+    // instead of readdir()'s per-DIR allocation.
+    JEB_FILE_SYSTEM *jeb_fs;
+    struct jeb_dirent64 *dp;
+    size_t allocated;
     uint32_t count;
-    char **entries;
-    int ret = 0;
+    char **entries, **tmp, *buf;
+    long nread;
+    int fd, ret = 0;
+    bool shared;
 
     *dirlistp = NULL;
     *countp = 0;
-    dirp = NULL;
-    // dirallocsz = 0;
+    jeb_fs = (JEB_FILE_SYSTEM *)fs;
     entries = NULL;
+    allocated = 0;
+    count = 0;
 
-    printf("JEB::jeb_fs_directory_list - dir: %s, prefix: %s\n", directory, prefix);
-
-    /*
-     * If opendir fails, we should have a NULL pointer with an error value, but various static
-     * analysis programs remain unconvinced, check both.
-     */
-    if ((dirp = opendir(directory)) == NULL || errno != 0) {
-        ret = EINVAL;
+    if ((fd = open(directory, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0) {
+        ret = errno;
+        fprintf(stderr, "failed to open directory %s: %s\n", directory, strerror(ret));
+        return ret;
     }
 
-    for (count = 0; (dp = readdir(dirp)) != NULL;) {
-        /*
-         * Skip . and ..
-         */
-        if (strcmp(dp->d_name, ".") == 0 || strcmp(dp->d_name, "..") == 0)
-            continue;
+    // use the file system's buffer unless another listing has it
+    if ((shared = pthread_mutex_trylock(&jeb_fs->dents_lock) == 0)) {
+        if (jeb_fs->dents_buf == NULL)
+            jeb_fs->dents_buf = malloc(DENTS_BUF_SIZE);
+        buf = jeb_fs->dents_buf;
+    } else
+        buf = malloc(DENTS_BUF_SIZE);
+    if (buf == NULL) {
+        ret = ENOMEM;
+        goto err;
+    }
 
-        /* The list of files is optionally filtered by a prefix. */
-        if (prefix != NULL && !JEB_PREFIX_MATCH(dp->d_name, prefix))
-            continue;
+    while ((nread = syscall(SYS_getdents64, fd, buf, DENTS_BUF_SIZE)) > 0) {
+        for (long pos = 0; pos < nread; pos += dp->d_reclen) {
+            dp = (struct jeb_dirent64 *)(buf + pos);
+
+            /*
+             * Skip . and ..
+             */
+            if (strcmp(dp->d_name, ".") == 0 || strcmp(dp->d_name, "..") == 0)
+                continue;
+
+            /* The list of files is optionally filtered by a prefix. */
+            if (prefix != NULL && !JEB_PREFIX_MATCH(dp->d_name, prefix))
+                continue;
+
+            if (count == allocated) {
+                allocated = allocated == 0 ? 64 : allocated * 2;
+                if ((tmp = realloc(entries, allocated * sizeof(char *))) == NULL) {
+                    ret = ENOMEM;
+                    goto err;
+                }
+                entries = tmp;
+            }
+            if ((entries[count] = strdup(dp->d_name)) == NULL) {
+                ret = ENOMEM;
+                goto err;
+            }
+            ++count;
+        }
+    }
+    if (nread < 0)
+        ret = errno;
 
-        // TODO: implement me
+err:
+    if (shared)
+        pthread_mutex_unlock(&jeb_fs->dents_lock);
+    else
+        free(buf);
+    (void)close(fd);
 
-        // WT_ERR(__wt_realloc_def(session, &dirallocsz, count + 1, &entries));
-        // WT_ERR(__wt_strdup(session, dp->d_name, &entries[count]));
-        // ++count;
+    if (ret == 0) {
+        // WT lists the home to find its files, and opens them soon after
+        if (jeb_fs->pf != NULL)
+            jeb_pf_queue(jeb_fs, directory, entries, count);
+        *dirlistp = entries;
+        *countp = count;
+        return (0);
     }
 
-    *dirlistp = entries;
-    *countp = count;
+    (void)jeb_fs_directory_list_free(fs, session, entries, count);
+    fprintf(stderr, "failed to list directory %s, prefix \"%s\": %s\n",
+      directory, prefix == NULL ? "" : prefix, strerror(ret));
     return ret;
-
-// err:
-//     WT_SYSCALL(closedir(dirp), tret);
-//     if (tret != 0) {
-//         __wt_err(session, tret, "%s: directory-list: closedir", directory);
-//         if (ret == 0)
-//             ret = tret;
-//     }
-
-//     if (ret == 0)
-//         return (0);
-
-//     WT_TRET(__wt_posix_directory_list_free(file_system, wt_session, entries, count));
-
-//     WT_RET_MSG(
-//       session, ret, "%s: directory-list, prefix \"%s\"", directory, prefix == NULL ? "" : prefix);
 }
 
 /* free memory allocated by jeb_fs_directory_list */
 static int 
 jeb_fs_directory_list_free(WT_FILE_SYSTEM *fs, WT_SESSION *session, char **dirlist, uint32_t count) {
-    printf("JEB::jeb_fs_directory_list_free\n");
-
-    // TODO: implement me
-
     if (dirlist != NULL) {
-        while (count > 0) {
-        //     __wt_free(session, dirlist[--count]);
-        }
-        // __wt_free(session, dirlist);
+        while (count > 0)
+            free(dirlist[--count]);
+        free(dirlist);
     }
     return 0;
 }
@@ -598,116 +5106,270 @@ jeb_fs_directory_list_free(WT_FILE_SYSTEM *fs, WT_SESSION *session, char **dirli
 static int 
 jeb_fs_terminate(WT_FILE_SYSTEM *fs, WT_SESSION *session) {
     JEB_FILE_SYSTEM *jeb_fs;
-    struct io_uring_sqe *sqe;
-    int ret = 0;
 
     jeb_fs = (JEB_FILE_SYSTEM *)fs;
 
-    printf("JEB::jeb_fs_terminate HEAD\n");
-    sqe = io_uring_get_sqe(&jeb_fs->ring);
-    io_uring_prep_nop(sqe);
-    RING_EVENT_USER_DATA *ud = malloc(sizeof(RING_EVENT_USER_DATA));
-    ud->event_type = EVENT_TYPE_SHUTDOWN;
-
-    /* Initialize mutex and condition variable objects */
-    pthread_mutex_init(&ud->mutex, NULL);
-    pthread_cond_init (&ud->condvar, NULL);
-    pthread_mutex_lock(&ud->mutex);
+    // the prefetch thread submits to the rings, it has to go first
+    if (jeb_fs->pf != NULL)
+        (void)jeb_fs->wtext->msg_printf(jeb_fs->wtext, session,
+          "JEB::open prefetch: %" PRIu64 " files opened ahead, %" PRIu64 " claimed",
+          jeb_fs->stats.pf_opened, jeb_fs->stats.pf_claimed);
+    jeb_pf_destroy(jeb_fs);
+
+    if (jeb_fs->cfg.admission) {
+        uint32_t lo = UINT32_MAX, hi = 0;
+        for (uint32_t i = 0; i < jeb_fs->nrings; i++) {
+            lo = jeb_fs->rings[i].adm_limit < lo ? jeb_fs->rings[i].adm_limit : lo;
+            hi = jeb_fs->rings[i].adm_limit > hi ? jeb_fs->rings[i].adm_limit : hi;
+        }
+        (void)jeb_fs->wtext->msg_printf(jeb_fs->wtext, session,
+          "JEB::admission: %" PRIu64 " submissions throttled, %" PRIu64 " window cuts, windows now %u-%u",
+          jeb_fs->stats.adm_waits, jeb_fs->stats.adm_cuts, lo, hi);
+    }
 
-    io_uring_sqe_set_data(sqe, ud);
-    io_uring_submit(&jeb_fs->ring);
+    jeb_rings_destroy(jeb_fs);
+    // folds the per-thread counters into jeb_fs->stats for the messages below
+    jeb_stats_destroy(jeb_fs);
+    if (jeb_fs->cfg.stats && jeb_fs->cfg.direct_io != 0)
+        (void)jeb_fs->wtext->msg_printf(jeb_fs->wtext, session,
+          "JEB::direct I/O: %" PRIu64 " requests bounced, %" PRIu64 " unaligned requests sent buffered",
+          jeb_fs->stats.dio_bounced, jeb_fs->stats.dio_unaligned);
+    if (jeb_fs->cfg.stats && jeb_fs->cfg.readahead != 0)
+        (void)jeb_fs->wtext->msg_printf(jeb_fs->wtext, session,
+          "JEB::readahead: %" PRIu64 " windows read, %" PRIu64 " reads served from them",
+          jeb_fs->stats.ra_issued, jeb_fs->stats.ra_hits);
+    if (jeb_fs->bcache != NULL) {
+        uint64_t hits = 0, misses = 0;
+        for (uint32_t i = 0; i < jeb_fs->cfg.bcache_shards; i++) {
+            hits += jeb_fs->bcache[i].hits;
+            misses += jeb_fs->bcache[i].misses;
+        }
+        (void)jeb_fs->wtext->msg_printf(jeb_fs->wtext, session,
+          "JEB::block cache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " inserts, %" PRIu64 " evictions",
+          hits, misses, jeb_fs->stats.bc_inserts, jeb_fs->stats.bc_evictions);
+    }
+    jeb_bcache_destroy(jeb_fs);
+    if (jeb_fs->cfg.stats && jeb_fs->meta != NULL)
+        (void)jeb_fs->wtext->msg_printf(jeb_fs->wtext, session,
+          "JEB::metadata cache: %" PRIu64 " hits, %" PRIu64 " misses",
+          jeb_fs->stats.meta_hits, jeb_fs->stats.meta_misses);
+    jeb_meta_destroy(jeb_fs);
+#ifndef JEB_NO_TRACE
+    jeb_trace_destroy(jeb_fs);
+#endif
+    if (jeb_fs->cfg.stats && jeb_fs->cfg.batch_entries != 0)
+        (void)jeb_fs->wtext->msg_printf(jeb_fs->wtext, session,
+          "JEB::submit batching: %" PRIu64 " submits, %" PRIu64 " SQEs",
+          jeb_fs->stats.submits, jeb_fs->stats.submit_sqes);
+    if (jeb_fs->cfg.io_classes)
+        (void)jeb_fs->wtext->msg_printf(jeb_fs->wtext, session,
+          "JEB::I/O classes: %" PRIu64 " reads/writes waited for their class's budget",
+          jeb_fs->stats.class_waits);
+
+    jeb_bufpool_destroy(&jeb_fs->regbufs);
+    jeb_bufpool_destroy(&jeb_fs->bounce);
+    if (jeb_fs->nfile_slots != 0)
+        jeb_freelist_destroy(&jeb_fs->file_slots);
+
+    for (uint32_t i = 0; i < jeb_fs->ndirfds; i++) {
+        (void)close(jeb_fs->dirfds[i].fd);
+        free(jeb_fs->dirfds[i].path);
+    }
+    pthread_mutex_destroy(&jeb_fs->dirfd_lock);
+    free(jeb_fs->dents_buf);
+    pthread_mutex_destroy(&jeb_fs->dents_lock);
+
+    if (jeb_fs->stats.ud_overflow != 0)
+        (void)jeb_fs->wtext->msg_printf(jeb_fs->wtext, session,
+          "JEB::completion slots: %" PRIu64 " allocated past the pool of %d",
+          jeb_fs->stats.ud_overflow, UD_POOL_SIZE);
+    jeb_ud_pool_destroy(jeb_fs);
+    free(jeb_fs);
+    return (0);
+}
+/* ! [JEB :: FILE_SYSTEM] */
 
-    // this should be in a loop to deal with spurious wakeups.
-    // should probably use pthread_cond_timedwait().
-    pthread_cond_wait(&ud->condvar, &ud->mutex);
-    pthread_mutex_unlock(&ud->mutex);
-    pthread_mutex_destroy(&ud->mutex);
-    pthread_cond_destroy(&ud->condvar);
-    free(ud);
+/* ! [JEB :: FILE HANDLE] */
+/* POSIX fadvise, without waiting for it */
+static int 
+jeb_fh_advise(WT_FILE_HANDLE *file_handle, WT_SESSION *session, wt_off_t offset, wt_off_t len, int advice) {
+    JEB_FILE_HANDLE *jeb_file_handle;
+    int posix_advice;
 
-    io_uring_queue_exit(&jeb_fs->ring);
+    jeb_file_handle = (JEB_FILE_HANDLE *)file_handle;
 
-    if ((ret = close(jeb_fs->efd)) != 0) {
-        fprintf(stderr, "problem closing eventd used with io_uring. ignoring but error is %s\n", strerror(ret));
+    switch (advice) {
+    case WT_FILE_HANDLE_DONTNEED:
+        posix_advice = POSIX_FADV_DONTNEED;
+        break;
+    case WT_FILE_HANDLE_WILLNEED:
+        posix_advice = POSIX_FADV_WILLNEED;
+        break;
+    default:
+        return (ENOTSUP);
     }
 
+    // nothing of an O_DIRECT file sits in the page cache
+    if (jeb_file_handle->direct_io)
+        return (0);
+
+    jeb_fh_fadvise_nowait(jeb_file_handle, session, offset, len, posix_advice);
     return (0);
 }
-/* ! [JEB :: FILE_SYSTEM] */
 
-/* ! [JEB :: FILE HANDLE] */
 static int 
 jeb_fh_close(WT_FILE_HANDLE *file_handle, WT_SESSION *session) {
     JEB_FILE_HANDLE *jeb_file_handle;
     JEB_FILE_SYSTEM *jeb_fs;
+    JEB_RING *ring;
     struct io_uring_sqe *sqe;
-    int ret = 0;
+    int ret = 0, wc_ret = 0;
 
     jeb_file_handle = (JEB_FILE_HANDLE *)file_handle;
     jeb_fs = jeb_file_handle->fs;
 
-    printf("JEB::jeb_fh_close - %s\n", file_handle->name);
-    sqe = io_uring_get_sqe(&jeb_fs->ring);
-    io_uring_prep_close(sqe, jeb_file_handle->fd);
-    RING_EVENT_USER_DATA *ud = malloc(sizeof(RING_EVENT_USER_DATA));
-    ud->event_type = EVENT_TYPE_NORMAL;
+    if (jeb_file_handle->wc_enabled)
+        wc_ret = jeb_wc_flush(jeb_file_handle, session);
+    for (int i = 0; i < 2; i++)
+        free(jeb_file_handle->wc[i].buf);
+    pthread_mutex_destroy(&jeb_file_handle->wc_lock);
+
+    // don't close the fd out from under a background flush
+    pthread_mutex_lock(&jeb_file_handle->flush_lock);
+    jeb_fh_flush_reap(jeb_file_handle, true);
+    pthread_mutex_unlock(&jeb_file_handle->flush_lock);
+    pthread_mutex_destroy(&jeb_file_handle->flush_lock);
+    pthread_mutex_lock(&jeb_file_handle->extend_lock);
+    jeb_fh_extend_reap(jeb_file_handle, true);
+    pthread_mutex_unlock(&jeb_file_handle->extend_lock);
+    pthread_mutex_destroy(&jeb_file_handle->extend_lock);
+    pthread_mutex_destroy(&jeb_file_handle->commit_lock);
+    pthread_mutex_destroy(&jeb_file_handle->map_lock);
+
+    for (int i = 0; i < JEB_RA_WINDOWS; i++) {
+        jeb_ra_reap(&jeb_file_handle->ra[i]);
+        free(jeb_file_handle->ra[i].buf);
+    }
+    pthread_mutex_destroy(&jeb_file_handle->ra_lock);
 
-    /* Initialize mutex and condition variable objects */
-    pthread_mutex_init(&ud->mutex, NULL);
-    pthread_cond_init (&ud->condvar, NULL);
-    pthread_mutex_lock(&ud->mutex);
+    // nothing can hit this open's file_id again, don't leave its blocks taking up the budget
+    if (jeb_fs->bcache != NULL)
+        jeb_bcache_invalidate_tail(jeb_file_handle, 0);
 
-    io_uring_sqe_set_data(sqe, ud);
-    io_uring_submit(&jeb_fs->ring);
+    // drop the registered slot first; the rings hold their own reference on the file
+    // until then, so the close below wouldn't actually release it otherwise.
+    jeb_fh_unregister_file(jeb_file_handle);
+    jeb_meta_closed(jeb_file_handle);
 
-    // this should be in a loop to deal with spurious wakeups.
-    // should probably use pthread_cond_timedwait().
-    pthread_cond_wait(&ud->condvar, &ud->mutex);
-    pthread_mutex_unlock(&ud->mutex);
-    pthread_mutex_destroy(&ud->mutex);
-    pthread_cond_destroy(&ud->condvar);
-    ret = ud->ret_code;
+    ring = jeb_ring_select(jeb_fs, session);
+    sqe = jeb_ring_get_sqe(ring);
+    io_uring_prep_close(sqe, jeb_file_handle->fd);
+    ret = jeb_ring_submit_and_wait(ring, sqe, EVENT_TYPE_NORMAL);
 
-    free(ud);
-    return ret;
+    if (jeb_file_handle->buffered_fd >= 0)
+        (void)close(jeb_file_handle->buffered_fd);
+
+    free(file_handle->name);
+    free(jeb_file_handle);
+    return (ret == 0 ? wc_ret : -ret);
+}
+
+/*
+* reap the handle's background extension, if there is one. with wait false, one that's
+* still running is left alone. extend_lock must be held.
+*/
+static void
+jeb_fh_extend_reap(JEB_FILE_HANDLE *fh, bool wait) {
+    if (!fh->extend_io.busy || (!wait && !jeb_detached_done(&fh->extend_io)))
+        return;
+
+    (void)jeb_detached_reap(&fh->extend_io);
+    if (fh->extend_io.res[0] < 0) {
+        // the size is whatever the kernel got to; start from a statx next time
+        fh->extend_err = -fh->extend_io.res[0];
+        fh->extend_end = -1;
+    } else
+        jeb_fh_size_grow(fh, fh->extend_end);
+    // reserving ahead is only an optimization. without KEEP_SIZE support, stop trying;
+    // anything else (ENOSPC, say), try again next time
+    if (fh->extend_io.res[1] == -EOPNOTSUPP)
+        fh->no_prealloc = true;
+    if (fh->extend_io.res[1] < 0)
+        fh->prealloc_end = 0;
 }
 
 static int 
 jeb_fh_extend(WT_FILE_HANDLE *file_handle, WT_SESSION *session, wt_off_t offset) {
+    // WT's posix layer allocates [0, offset) and waits for it. this allocates only the new
+    // tail and doesn't wait: the fallocate goes on the ring and gets reaped by the next
+    // extend, or by whatever needs the size to be right (fh_size, truncate, sync, close).
+    // with preallocate set, the space past the end is reserved a step at a time with
+    // FALLOC_FL_KEEP_SIZE, so the tail fallocate mostly just moves i_size.
     JEB_FILE_HANDLE *jeb_file_handle;
     JEB_FILE_SYSTEM *jeb_fs;
+    JEB_RING *ring;
+    RING_EVENT_USER_DATA *ud;
     struct io_uring_sqe *sqe;
+    wt_off_t from, prealloc_from, step;
+    uint32_t n;
     int ret = 0;
 
     jeb_file_handle = (JEB_FILE_HANDLE *)file_handle;
     jeb_fs = jeb_file_handle->fs;
-
-    // TODO: there's a bunch of extra logic around the extend() functions in WT
-    // wrt mapping the file (to prevent races). will need to account for that  ...
-
-    printf("JEB::jeb_fh_extend - %s\n", file_handle->name);
-    sqe = io_uring_get_sqe(&jeb_fs->ring);
-    io_uring_prep_fallocate(sqe, jeb_file_handle->fd, 0, (wt_off_t)0, offset);
-    RING_EVENT_USER_DATA *ud = malloc(sizeof(RING_EVENT_USER_DATA));
-    ud->event_type = EVENT_TYPE_NORMAL;
-
-    /* Initialize mutex and condition variable objects */
-    pthread_mutex_init(&ud->mutex, NULL);
-    pthread_cond_init (&ud->condvar, NULL);
-    pthread_mutex_lock(&ud->mutex);
-
+    step = (wt_off_t)jeb_fs->cfg.preallocate;
+
+    // growing the file doesn't disturb live mappings (they keep their length, WT maps
+    // again to see the new space), so no need to take map_lock here.
+
+    pthread_mutex_lock(&jeb_file_handle->extend_lock);
+    // the last extension is usually long done; only wait for it if this one goes further
+    jeb_fh_extend_reap(jeb_file_handle, false);
+    if (jeb_file_handle->extend_io.busy && offset > jeb_file_handle->extend_end)
+        jeb_fh_extend_reap(jeb_file_handle, true);
+    if ((ret = jeb_file_handle->extend_err) != 0) {
+        jeb_file_handle->extend_err = 0;
+        goto done;
+    }
+    // nothing is in flight when extend_end isn't known, so fh_size won't want extend_lock
+    if (jeb_file_handle->extend_end < 0 &&
+      (ret = jeb_fh_size(file_handle, session, &jeb_file_handle->extend_end)) != 0)
+        goto done;
+    if (offset <= jeb_file_handle->extend_end)
+        goto done;
+
+    from = jeb_file_handle->extend_end;
+    // keep a step reserved past the end, topped back up once half of it is used
+    n = step != 0 && !jeb_file_handle->no_prealloc &&
+      offset + step / 2 > jeb_file_handle->prealloc_end ? 2 : 1;
+    // both fallocates take background budget at once, a budget of 1 can't fit the reserve
+    if (n == 2 && jeb_fs->cfg.class_depth[JEB_CLASS_BACKGROUND] == 1)
+        n = 1;
+    ring = jeb_ring_select(jeb_fs, session);
+    jeb_class_enter(jeb_fs, ring, JEB_CLASS_BACKGROUND, n);
+    jeb_ring_admit(ring, n);
+    ud = jeb_ud_get_detached(jeb_fs, &jeb_file_handle->extend_io, n);
+    jeb_ud_class(ud, ring, JEB_CLASS_BACKGROUND);
+
+    pthread_mutex_lock(&ring->sq_lock);
+    sqe = jeb_ring_next_sqe(ring);
+    io_uring_prep_fallocate(sqe, jeb_file_handle->fd, 0, from, offset - from);
+    jeb_sqe_fixed_file(ring, sqe, jeb_file_handle);
+    jeb_sqe_ioprio(jeb_fs, sqe, JEB_CLASS_BACKGROUND);
     io_uring_sqe_set_data(sqe, ud);
-    io_uring_submit(&jeb_fs->ring);
-
-    // this should be in a loop to deal with spurious wakeups.
-    // should probably use pthread_cond_timedwait().
-    pthread_cond_wait(&ud->condvar, &ud->mutex);
-    pthread_mutex_unlock(&ud->mutex);
-    pthread_mutex_destroy(&ud->mutex);
-    pthread_cond_destroy(&ud->condvar);
-    ret = ud->ret_code;
-
-    free(ud);
+    if (n == 2) {
+        prealloc_from = offset > jeb_file_handle->prealloc_end ? offset : jeb_file_handle->prealloc_end;
+        sqe = jeb_ring_next_sqe(ring);
+        io_uring_prep_fallocate(sqe, jeb_file_handle->fd, FALLOC_FL_KEEP_SIZE, prealloc_from,
+          offset + step - prealloc_from);
+        jeb_sqe_fixed_file(ring, sqe, jeb_file_handle);
+        jeb_sqe_ioprio(jeb_fs, sqe, JEB_CLASS_BACKGROUND);
+        io_uring_sqe_set_data(sqe, (void *)((uintptr_t)ud | 1));
+        jeb_file_handle->prealloc_end = offset + step;
+    }
+    jeb_ring_submit_unlock(ring);
+    jeb_file_handle->extend_end = offset;
+done:
+    pthread_mutex_unlock(&jeb_file_handle->extend_lock);
     return ret;
 }
 
@@ -749,45 +5411,32 @@ jeb_fh_lock(WT_FILE_HANDLE *file_handle, WT_SESSION *session, bool lock) {
 static int 
 jeb_fh_read(WT_FILE_HANDLE *file_handle, WT_SESSION *session, wt_off_t offset, 
     size_t len, void *buf) {
-    printf("JEB::jeb_fh_read - %s\n", file_handle->name);
     JEB_FILE_HANDLE *jeb_file_handle;
-    JEB_FILE_SYSTEM *jeb_fs;
-    struct io_uring_sqe *sqe;
+    uint64_t gen = 0;
     int ret = 0;
+    bool cacheable;
 
     jeb_file_handle = (JEB_FILE_HANDLE *)file_handle;
-    jeb_fs = jeb_file_handle->fs;
+    if (jeb_file_handle->wc_enabled)
+        jeb_wc_flush_overlap(jeb_file_handle, session, offset, offset + (wt_off_t)len);
 
-    // TODO: depending on the size of the incoming buffer, might want to break this 
-    // up into multiple SQEs. That is what WT does in __posix_file_read().
+    cacheable = jeb_file_handle->fs->bcache != NULL && len <= JEB_BC_MAX_ITEM;
+    if (cacheable && jeb_bcache_lookup(jeb_file_handle, offset, len, buf, &gen))
+        return 0;
 
-    sqe = io_uring_get_sqe(&jeb_fs->ring);
-    io_uring_prep_read(sqe, jeb_file_handle->fd, buf, len, offset);
-    RING_EVENT_USER_DATA *ud = malloc(sizeof(RING_EVENT_USER_DATA));
-    ud->event_type = EVENT_TYPE_NORMAL;
-    
-    /* Initialize mutex and condition variable objects */
-    pthread_mutex_init(&ud->mutex, NULL);
-    pthread_cond_init (&ud->condvar, NULL);
-    pthread_mutex_lock(&ud->mutex);
+    // sequential scans are served by readahead and kept out of the block cache
+    if (jeb_file_handle->fs->cfg.readahead != 0 &&
+      jeb_ra_read(jeb_file_handle, session, offset, len, buf))
+        return 0;
 
-    io_uring_sqe_set_data(sqe, ud);
-    io_uring_submit(&jeb_fs->ring);
-    
-    // this should be in a loop to deal with spurious wakeups.
-    // should probably use pthread_cond_timedwait().
-    pthread_cond_wait(&ud->condvar, &ud->mutex);
-    pthread_mutex_unlock(&ud->mutex);
-    pthread_mutex_destroy(&ud->mutex);
-    pthread_cond_destroy(&ud->condvar);
-    ret = ud->ret_code;
-    free(ud);
-
-    if (ret < 0) {
-        fprintf(stderr, "failure reading from file: %s\n", strerror(ret));
+    if ((ret = jeb_fh_rw(jeb_file_handle, session, offset, len, buf, false)) != 0) {
+        fprintf(stderr, "failure reading %zu bytes at offset %" PRId64 " from %s: %s\n",
+          len, (int64_t)offset, file_handle->name, ret == WT_ERROR ? "short read" : strerror(ret));
         return ret;
     }
 
+    if (cacheable)
+        jeb_bcache_insert(jeb_file_handle, offset, len, buf, gen);
     return 0;
 }
 
@@ -797,43 +5446,67 @@ jeb_fh_size(WT_FILE_HANDLE *file_handle, WT_SESSION *session, wt_off_t *sizep) {
     // NOTE: almost exactly the same as jeb_fs_size() - only diff is args to statx()
     JEB_FILE_HANDLE *jeb_file_handle;
     JEB_FILE_SYSTEM *jeb_fs;
+    JEB_RING *ring;
     struct statx statx;
     struct io_uring_sqe *sqe;
     int ret = 0;
     int flags = 0;
 
-    printf("JEB::jeb_fh_size %s\n", file_handle->name);
     jeb_file_handle = (JEB_FILE_HANDLE *)file_handle;
     jeb_fs = jeb_file_handle->fs;
-    flags |= AT_EMPTY_PATH;
-    sqe = io_uring_get_sqe(&jeb_fs->ring);
-    io_uring_prep_statx(sqe, jeb_file_handle->fd, "", flags, 0, &statx);
-    RING_EVENT_USER_DATA *ud = malloc(sizeof(RING_EVENT_USER_DATA));
-    ud->event_type = EVENT_TYPE_NORMAL;
-    
-    /* Initialize mutex and condition variable objects */
-    pthread_mutex_init(&ud->mutex, NULL);
-    pthread_cond_init (&ud->condvar, NULL);
-    pthread_mutex_lock(&ud->mutex);
 
-    io_uring_sqe_set_data(sqe, ud);
-    io_uring_submit(&jeb_fs->ring);
+    // an extension WT has been told is done has to show up in the size
+    if (__atomic_load_n(&jeb_file_handle->extend_io.busy, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_lock(&jeb_file_handle->extend_lock);
+        jeb_fh_extend_reap(jeb_file_handle, true);
+        pthread_mutex_unlock(&jeb_file_handle->extend_lock);
+    }
 
-    // this should be in a loop to deal with spurious wakeups.
-    // should probably use pthread_cond_timedwait().
-    pthread_cond_wait(&ud->condvar, &ud->mutex);
-    pthread_mutex_unlock(&ud->mutex);
-    pthread_mutex_destroy(&ud->mutex);
-    pthread_cond_destroy(&ud->condvar);
-    ret = ud->ret_code;
+    // staged writes are already counted in the cached size
+    if (jeb_fs->meta != NULL && __atomic_load_n(&jeb_file_handle->size_known, __ATOMIC_ACQUIRE)) {
+        *sizep = __atomic_load_n(&jeb_file_handle->size, __ATOMIC_RELAXED);
+        JEB_TSTAT_INCR(jeb_fs, meta_hits, 1);
+        return (0);
+    }
 
-    free(ud);
+    // staged writes past the end of the file count toward its size
+    if (jeb_file_handle->wc_enabled && (ret = jeb_wc_flush(jeb_file_handle, session)) != 0)
+        return (ret);
+    flags |= AT_EMPTY_PATH;
+    ring = jeb_ring_select(jeb_fs, session);
+    sqe = jeb_ring_get_sqe(ring);
+    io_uring_prep_statx(sqe, jeb_file_handle->fd, "", flags, STATX_SIZE, &statx);
+    ret = jeb_ring_submit_and_wait(ring, sqe, EVENT_TYPE_NORMAL);
     if (ret == 0) {
-        *sizep = statx.stx_size;
+        if (jeb_fs->meta == NULL) {
+            *sizep = statx.stx_size;
+            return (0);
+        }
+        // writes that finished after the statx have already pushed size past it
+        JEB_STAT_INCR(jeb_fs, meta_misses);
+        jeb_fh_size_grow(jeb_file_handle, (wt_off_t)statx.stx_size);
+        __atomic_store_n(&jeb_file_handle->size_known, true, __ATOMIC_RELEASE);
+        *sizep = __atomic_load_n(&jeb_file_handle->size, __ATOMIC_RELAXED);
         return (0);
     }
 
-    return ret;
+    return (-ret);
+}
+
+/*
+* reap the handle's background flush, if there is one. with wait false, a flush that's
+* still running is left alone. flush_lock must be held.
+*/
+static void
+jeb_fh_flush_reap(JEB_FILE_HANDLE *fh, bool wait) {
+    if (!fh->flush_io.busy || (!wait && !jeb_detached_done(&fh->flush_io)))
+        return;
+
+    // nothing is lost on failure: the fsync that eventually follows writes it all back again
+    (void)jeb_detached_reap(&fh->flush_io);
+    if (fh->flush_io.res[0] < 0)
+        fprintf(stderr, "background flush of %s failed: %s\n", fh->iface.name,
+          strerror(-fh->flush_io.res[0]));
 }
 
 /* ensure file content is stable */
@@ -841,44 +5514,80 @@ static int
 jeb_fh_sync(WT_FILE_HANDLE *file_handle, WT_SESSION *session) {
     JEB_FILE_HANDLE *jeb_file_handle;
     JEB_FILE_SYSTEM *jeb_fs;
+    JEB_RING *ring;
     struct io_uring_sqe *sqe;
     int ret = 0;
 
-    printf("JEB::jeb_fh_sync - %s\n", file_handle->name);
-
     jeb_file_handle = (JEB_FILE_HANDLE *)file_handle;
     jeb_fs = jeb_file_handle->fs;
 
-    sqe = io_uring_get_sqe(&jeb_fs->ring);
-    io_uring_prep_fsync(sqe, jeb_file_handle->fd, 0);
-    RING_EVENT_USER_DATA *ud = malloc(sizeof(RING_EVENT_USER_DATA));
-    ud->event_type = EVENT_TYPE_NORMAL;
-
-    /* Initialize mutex and condition variable objects */
-    pthread_mutex_init(&ud->mutex, NULL);
-    pthread_cond_init (&ud->condvar, NULL);
-    pthread_mutex_lock(&ud->mutex);
-
-    io_uring_sqe_set_data(sqe, ud);
-    io_uring_submit(&jeb_fs->ring);
+    // staged writes have to reach the file before it's synced
+    if (jeb_file_handle->wc_enabled && (ret = jeb_wc_flush(jeb_file_handle, session)) != 0)
+        return ret;
 
-    // this should be in a loop to deal with spurious wakeups.
-    // should probably use pthread_cond_timedwait().
-    pthread_cond_wait(&ud->condvar, &ud->mutex);
-    pthread_mutex_unlock(&ud->mutex);
-    pthread_mutex_destroy(&ud->mutex);
-    pthread_cond_destroy(&ud->condvar);
-    ret = ud->ret_code;
+    // let any writeback fh_sync_nowait started finish first, so the fsync below only
+    // has whatever got dirtied since
+    pthread_mutex_lock(&jeb_file_handle->flush_lock);
+    jeb_fh_flush_reap(jeb_file_handle, true);
+    pthread_mutex_unlock(&jeb_file_handle->flush_lock);
+
+    // the fsync has to cover the allocation too, and report it if it failed
+    pthread_mutex_lock(&jeb_file_handle->extend_lock);
+    jeb_fh_extend_reap(jeb_file_handle, true);
+    ret = jeb_file_handle->extend_err;
+    jeb_file_handle->extend_err = 0;
+    pthread_mutex_unlock(&jeb_file_handle->extend_lock);
+    if (ret != 0)
+        return ret;
 
-    free(ud);
-    return ret;
+    ring = jeb_ring_select(jeb_fs, session);
+    sqe = jeb_ring_get_sqe(ring);
+    io_uring_prep_fsync(sqe, jeb_file_handle->fd, 0);
+    jeb_sqe_fixed_file(ring, sqe, jeb_file_handle);
+    ret = jeb_ring_submit_and_wait(ring, sqe, EVENT_TYPE_NORMAL);
+    return (ret < 0 ? -ret : 0);
 }
 
-/* ensure file content is stable */
+/*
+* start writeback of the file's dirty pages and return without waiting for it. if the
+* previous one is still running, this one merges into it.
+*/
 static int 
 jeb_fh_sync_nowait(WT_FILE_HANDLE *file_handle, WT_SESSION *session) {
-    printf("JEB::jeb_fh_sync_nowait\n");
-    return (ENOTSUP);
+    JEB_FILE_HANDLE *jeb_file_handle;
+    JEB_RING *ring;
+    RING_EVENT_USER_DATA *ud;
+    struct io_uring_sqe *sqe;
+
+    jeb_file_handle = (JEB_FILE_HANDLE *)file_handle;
+
+    // get staged writes moving too; the writeback below only picks up what they've reached
+    if (jeb_file_handle->wc_enabled) {
+        pthread_mutex_lock(&jeb_file_handle->wc_lock);
+        jeb_wc_rotate(jeb_file_handle, session);
+        pthread_mutex_unlock(&jeb_file_handle->wc_lock);
+    }
+
+    pthread_mutex_lock(&jeb_file_handle->flush_lock);
+    jeb_fh_flush_reap(jeb_file_handle, false);
+    if (jeb_file_handle->flush_io.busy) {
+        pthread_mutex_unlock(&jeb_file_handle->flush_lock);
+        return (0);
+    }
+
+    // zero offset and length mean the whole file. the result waits in flush_io until the
+    // next fh_sync/fh_sync_nowait/fh_close reaps it.
+    ring = jeb_ring_select(jeb_file_handle->fs, session);
+    jeb_class_enter(jeb_file_handle->fs, ring, JEB_CLASS_BACKGROUND, 1);
+    sqe = jeb_ring_get_sqe(ring);
+    ud = jeb_ud_get_detached(jeb_file_handle->fs, &jeb_file_handle->flush_io, 1);
+    jeb_ud_class(ud, ring, JEB_CLASS_BACKGROUND);
+    io_uring_prep_sync_file_range(sqe, jeb_file_handle->fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+    jeb_sqe_fixed_file(ring, sqe, jeb_file_handle);
+    jeb_sqe_ioprio(jeb_file_handle->fs, sqe, JEB_CLASS_BACKGROUND);
+    jeb_ring_submit_nowait(ring, sqe, ud);
+    pthread_mutex_unlock(&jeb_file_handle->flush_lock);
+    return (0);
 }
 
 /* POSIX truncate */
@@ -887,29 +5596,45 @@ jeb_fh_truncate(WT_FILE_HANDLE *file_handle, WT_SESSION *session, wt_off_t len)
     JEB_FILE_HANDLE *jeb_file_handle;
     int ret = 0;
 
-    // TODO: there's a bunch of extra logic around the truncate() functions in WT
-    // wrt mapping the file (to prevent races). will need to account for that  ...
-
-    printf("JEB::jeb_fh_truncate - %s, new len: %ld\n", file_handle->name, len);
     jeb_file_handle = (JEB_FILE_HANDLE *)file_handle;
 
-    // TODO: re-enable this mmap stuffs
-    // remap = (len != pfh->mmap_size);
-    // if (remap)
-    //     __wt_prepare_remap_resize_file(file_handle, wt_session);
-
-    if ((ret = ftruncate(jeb_file_handle->fd, len)) != 0) {
+    // a staged write landing after the truncate would grow the file back
+    if (jeb_file_handle->wc_enabled && (ret = jeb_wc_flush(jeb_file_handle, session)) != 0)
+        return (ret);
+    // ... as would an extension still in flight. extend_lock isn't held across the
+    // truncate, fh_map takes it (through fh_size) under map_lock
+    pthread_mutex_lock(&jeb_file_handle->extend_lock);
+    jeb_fh_extend_reap(jeb_file_handle, true);
+    pthread_mutex_unlock(&jeb_file_handle->extend_lock);
+
+    // rather than remapping under WT's feet (what WT's posix layer does), refuse to cut
+    // into a live mapping. WT's block manager treats EBUSY from truncate as "try later".
+    pthread_mutex_lock(&jeb_file_handle->map_lock);
+    if (jeb_file_handle->nmaps != 0 && (size_t)len < jeb_file_handle->map_len) {
+        pthread_mutex_unlock(&jeb_file_handle->map_lock);
+        return (EBUSY);
+    }
+    if (ftruncate(jeb_file_handle->fd, len) != 0)
+        ret = errno;
+    else {
+        __atomic_store_n(&jeb_file_handle->size, len, __ATOMIC_RELAXED);
+        __atomic_store_n(&jeb_file_handle->size_known, true, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&jeb_file_handle->map_lock);
+    // cutting the file drops the reserved space past it as well; start over on both
+    pthread_mutex_lock(&jeb_file_handle->extend_lock);
+    jeb_file_handle->extend_end = -1;
+    jeb_file_handle->prealloc_end = 0;
+    pthread_mutex_unlock(&jeb_file_handle->extend_lock);
+    if (jeb_file_handle->fs->cfg.readahead != 0)
+        jeb_ra_invalidate(jeb_file_handle, len, -1);
+    if (jeb_file_handle->fs->bcache != NULL)
+        jeb_bcache_invalidate_tail(jeb_file_handle, len);
+
+    if (ret != 0) {
         fprintf(stderr, "failed to truncate %s, err: %s\n", file_handle->name, strerror(ret));
         return ret;
     }
-    // if (remap) {
-    //     if (ret == 0)
-    //         __wt_remap_resize_file(file_handle, wt_session);
-    //     else {
-    //         __wt_release_without_remap(file_handle);
-    //         WT_RET_MSG(session, ret, "%s: handle-truncate: ftruncate", file_handle->name);
-    //     }
-    // }
     return (0);
 }
 
@@ -918,40 +5643,28 @@ static int
 jeb_fh_write(WT_FILE_HANDLE *file_handle, WT_SESSION *session, wt_off_t offset, 
     size_t len, const void *buf) {
     JEB_FILE_HANDLE *jeb_file_handle;
-    JEB_FILE_SYSTEM *jeb_fs;
-    struct io_uring_sqe *sqe;
     int ret = 0;
 
     jeb_file_handle = (JEB_FILE_HANDLE *)file_handle;
-    jeb_fs = jeb_file_handle->fs;
-
-    // TODO: depending on the size of the incoming buffer, might want to break this 
-    // up into multiple SQEs. That is what WT does in __posix_file_write().
-
-    sqe = io_uring_get_sqe(&jeb_fs->ring);
-    io_uring_prep_write(sqe, jeb_file_handle->fd, buf, len, offset);
-    RING_EVENT_USER_DATA *ud = malloc(sizeof(RING_EVENT_USER_DATA));
-    ud->event_type = EVENT_TYPE_NORMAL;
-    
-    /* Initialize mutex and condition variable objects */
-    pthread_mutex_init(&ud->mutex, NULL);
-    pthread_cond_init (&ud->condvar, NULL);
-    pthread_mutex_lock(&ud->mutex);
-
-    io_uring_sqe_set_data(sqe, ud);
-    io_uring_submit(&jeb_fs->ring);
-    
-    // this should be in a loop to deal with spurious wakeups.
-    // should probably use pthread_cond_timedwait().
-    pthread_cond_wait(&ud->condvar, &ud->mutex);
-    pthread_mutex_unlock(&ud->mutex);
-    pthread_mutex_destroy(&ud->mutex);
-    pthread_cond_destroy(&ud->condvar);
-    ret = ud->ret_code;
-    free(ud);
-
-    if (ret < 0) {
-        fprintf(stderr, "failure writing to file: %s\n", strerror(ret));
+    if (jeb_file_handle->wc_enabled && jeb_wc_write(jeb_file_handle, session, offset, len, buf))
+        ret = 0;
+    else if (jeb_file_handle->group_commit && len <= JEB_CHUNK_LIMIT)
+        ret = jeb_fh_commit_write(jeb_file_handle, session, offset, len, buf);
+    else {
+        ret = jeb_fh_rw(jeb_file_handle, session, offset, len, (char *)buf, true);
+        // too big for a commit chain; the file was opened without O_DSYNC, so sync it here
+        if (ret == 0 && jeb_file_handle->group_commit)
+            ret = jeb_fh_datasync(jeb_file_handle, session);
+    }
+    jeb_fh_cache_invalidate(jeb_file_handle, offset, offset + (wt_off_t)len);
+    // a failed write may have extended the file by any amount, go back to asking the kernel
+    if (ret == 0)
+        jeb_fh_size_grow(jeb_file_handle, offset + (wt_off_t)len);
+    else
+        __atomic_store_n(&jeb_file_handle->size_known, false, __ATOMIC_RELEASE);
+    if (ret != 0) {
+        fprintf(stderr, "failure writing %zu bytes at offset %" PRId64 " to %s: %s\n",
+          len, (int64_t)offset, file_handle->name, strerror(ret));
         return ret;
     }
 
@@ -961,35 +5674,133 @@ jeb_fh_write(WT_FILE_HANDLE *file_handle, WT_SESSION *session, wt_off_t offset,
 /* Map a file into memory */
 static int 
 jeb_fh_map(WT_FILE_HANDLE *file_handle, WT_SESSION *session, void *mapped_region, size_t *length, void *mapped_cookie) {
-    printf("JEB::jeb_fh_map\n");
-    return (ENOTSUP);
+    JEB_FILE_HANDLE *jeb_file_handle;
+    wt_off_t file_size;
+    void *map;
+    int ret = 0;
+
+    jeb_file_handle = (JEB_FILE_HANDLE *)file_handle;
+
+    // same as WT: mapping and O_DIRECT don't mix
+    if (jeb_file_handle->direct_io)
+        return (ENOTSUP);
+
+    // the cached size counts staged writes, the mapping needs them in the file
+    if (jeb_file_handle->wc_enabled && (ret = jeb_wc_flush(jeb_file_handle, session)) != 0)
+        return (ret);
+
+    pthread_mutex_lock(&jeb_file_handle->map_lock);
+    if ((ret = jeb_fh_size(file_handle, session, &file_size)) != 0)
+        goto err;
+    if (file_size == 0) {
+        ret = EINVAL;
+        goto err;
+    }
+
+    // read-only, private: WT only ever reads through the map, writes go through fh_write
+    if ((map = mmap(NULL, (size_t)file_size, PROT_READ, MAP_PRIVATE, jeb_file_handle->fd, 0)) == MAP_FAILED) {
+        ret = errno;
+        goto err;
+    }
+
+    ++jeb_file_handle->nmaps;
+    if ((size_t)file_size > jeb_file_handle->map_len)
+        jeb_file_handle->map_len = (size_t)file_size;
+    pthread_mutex_unlock(&jeb_file_handle->map_lock);
+
+    *(void **)mapped_region = map;
+    *length = (size_t)file_size;
+    return (0);
+
+err:
+    pthread_mutex_unlock(&jeb_file_handle->map_lock);
+    fprintf(stderr, "failed to map %s: %s\n", file_handle->name, strerror(ret));
+    return (ret);
+}
+
+/*
+* page-align a range of a mapping for madvise(), and prep the MADVISE SQE. madvise wants
+* an aligned start address; the length doesn't matter. the SQE only carries 32 bits of
+* length, which is plenty for the per-block ranges WT passes.
+*/
+static void
+jeb_prep_madvise(struct io_uring_sqe *sqe, const void *addr, size_t length, int advice) {
+    uintptr_t start, page_mask;
+
+    page_mask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+    start = (uintptr_t)addr & ~page_mask;
+    length += (uintptr_t)addr - start;
+    if (length > (UINT32_MAX & ~page_mask))
+        length = UINT32_MAX & ~page_mask;
+    io_uring_prep_madvise(sqe, (void *)start, (uint32_t)length, advice);
 }
 
 /* Unmap part of a memory mapped file */
 static int 
 jeb_fh_map_discard(WT_FILE_HANDLE *file_handle, WT_SESSION *session, void *mapped_region, size_t length, void *mapped_cookie) {
-    printf("JEB::jeb_fh_map_discard\n");
-    return (ENOTSUP);
+    JEB_FILE_HANDLE *jeb_file_handle;
+    JEB_RING *ring;
+    struct io_uring_sqe *sqe;
+    int ret = 0;
+
+    jeb_file_handle = (JEB_FILE_HANDLE *)file_handle;
+
+    // synchronous, unlike preload: once WT unmaps, DONTNEED on a recycled address range
+    // would zap somebody else's memory
+    ring = jeb_ring_select(jeb_file_handle->fs, session);
+    sqe = jeb_ring_get_sqe(ring);
+    jeb_prep_madvise(sqe, mapped_region, length, MADV_DONTNEED);
+    if ((ret = -jeb_ring_submit_and_wait(ring, sqe, EVENT_TYPE_NORMAL)) != 0)
+        fprintf(stderr, "failed to discard mapped pages of %s: %s\n", file_handle->name, strerror(ret));
+    return (ret);
 }
 
 /* Preload part of a memory mapped file */
 static int 
 jeb_fh_map_preload(WT_FILE_HANDLE *file_handle, WT_SESSION *session, const void *mapped_region, size_t length, void *mapped_cookie) {
-    printf("JEB::jeb_fh_map_preload\n");
-    return (ENOTSUP);
+    JEB_FILE_HANDLE *jeb_file_handle;
+    JEB_RING *ring;
+    RING_EVENT_USER_DATA *ud;
+    struct io_uring_sqe *sqe;
+
+    jeb_file_handle = (JEB_FILE_HANDLE *)file_handle;
+
+    // fire and forget: WILLNEED is only a hint, and harmless even if the range has been
+    // unmapped by the time the kernel gets to it
+    ring = jeb_ring_select(jeb_file_handle->fs, session);
+    sqe = jeb_ring_get_sqe(ring);
+    ud = jeb_ud_get(jeb_file_handle->fs, EVENT_TYPE_ASYNC);
+    jeb_prep_madvise(sqe, mapped_region, length, MADV_WILLNEED);
+    jeb_ring_submit_nowait(ring, sqe, ud);
+    return (0);
 }
 
 /* Unmap a memory mapped file */
 static int 
 jeb_fh_unmap(WT_FILE_HANDLE *file_handle, WT_SESSION *session, void *mapped_region, size_t length, void *mapped_cookie) {
-    printf("JEB::jeb_fh_unmap\n");
-    return (ENOTSUP);
+    JEB_FILE_HANDLE *jeb_file_handle;
+    int ret = 0;
+
+    jeb_file_handle = (JEB_FILE_HANDLE *)file_handle;
+
+    if (munmap(mapped_region, length) != 0) {
+        ret = errno;
+        fprintf(stderr, "failed to unmap %s: %s\n", file_handle->name, strerror(ret));
+        return (ret);
+    }
+
+    pthread_mutex_lock(&jeb_file_handle->map_lock);
+    if (--jeb_file_handle->nmaps == 0)
+        jeb_file_handle->map_len = 0;
+    pthread_mutex_unlock(&jeb_file_handle->map_lock);
+    return (0);
 }
 
 /* ! [JEB :: FILE HANDLE] */
 
 
 
+#ifndef JEB_NO_MAIN
 int
 main(int args, char *argv[]) {
     WT_CONNECTION *conn;
@@ -1053,4 +5864,5 @@ main(int args, char *argv[]) {
         return -1;
     }
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,93 @@
+#ifndef WT_URING_H
+#define WT_URING_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "wiredtiger.h"
+
+/*
+* Entry point named in the extension config, see create_custom_file_system() in wt_uring.c.
+*/
+int create_custom_file_system(WT_CONNECTION *, WT_CONFIG_ARG *);
+
+/*
+* Build the file system without installing it in the connection, for driving its callbacks
+* directly (see wt_uring_bench.c). config is what would go in the extension's config=(...),
+* e.g. "queue_depth=64,rings=4". conn only supplies the extension API and the home directory.
+* Call terminate on the result when done.
+*/
+int wt_uring_file_system_create(WT_CONNECTION *conn, const char *config, WT_FILE_SYSTEM **file_systemp);
+
+/*
+* Write the file system's per-operation counters and latency histograms to fp. They are
+* split by operation and file type and summed over all threads. Only available when the
+* extension is configured with stats=(enabled=true). Returns 0, ENOENT if stats aren't
+* enabled, or the errno from flushing fp.
+*
+* Don't call this while the connection is closing.
+*/
+int wt_uring_stats_dump(FILE *fp);
+
+/*
+* Operation and file type codes, shared by the stats and the trace records.
+*/
+#define WT_URING_OP_READ      0
+#define WT_URING_OP_WRITE     1
+#define WT_URING_OP_SYNC      2
+#define WT_URING_OP_OPEN      3
+#define WT_URING_OP_STATX     4
+#define WT_URING_OP_FALLOCATE 5
+#define WT_URING_OP_CLOSE     6
+#define WT_URING_OP_TRUNCATE  7 /* trace only, from here on */
+#define WT_URING_OP_REMOVE    8
+#define WT_URING_OP_RENAME    9
+
+#define WT_URING_FTYPE_DATA   0
+#define WT_URING_FTYPE_LOG    1
+#define WT_URING_FTYPE_DIR    2
+#define WT_URING_FTYPE_OTHER  3
+
+/*
+* Trace file layout (trace=(enabled=true)): one WT_URING_TRACE_HEADER, then for each thread
+* that recorded anything a WT_URING_TRACE_THREAD followed by its count records, oldest
+* first. Everything is in host byte order.
+*/
+#define WT_URING_TRACE_MAGIC   "WTURTRC1"
+#define WT_URING_TRACE_VERSION 1
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;   /* sizeof(WT_URING_TRACE_RECORD) */
+} WT_URING_TRACE_HEADER;
+
+typedef struct {
+    uint32_t tid;
+    uint32_t count;
+} WT_URING_TRACE_THREAD;
+
+typedef struct {
+    uint64_t start_ns;      /* CLOCK_MONOTONIC at callback entry */
+    uint64_t end_ns;        /* ... and at return */
+    int64_t offset;         /* read/write/truncate/extend, else 0 */
+    uint64_t len;
+    uint32_t queue_ns;      /* time to get the SQEs published, saturates at UINT32_MAX */
+    uint32_t service_ns;    /* submit until the CQEs were reaped, ditto */
+    int32_t fd;             /* -1 for calls that take a name */
+    int32_t result;         /* 0 or the error returned to WiredTiger */
+    uint16_t op;            /* WT_URING_OP_* */
+    uint16_t file_type;     /* WT_URING_FTYPE_* */
+    uint32_t pad;
+} WT_URING_TRACE_RECORD;
+
+/*
+* Write the per-thread trace rings to path in the layout above. Returns 0, ENOENT if
+* tracing isn't enabled (or was compiled out with -DJEB_NO_TRACE), or an errno from writing
+* the file. A record being overwritten while the dump copies it is dropped, not torn.
+*
+* Don't call this while the connection is closing.
+*/
+int wt_uring_trace_dump(const char *path);
+
+#endif
@@ -0,0 +1,578 @@
+/*
+* Microbenchmark for the io_uring file system. Drives the WT_FILE_SYSTEM/WT_FILE_HANDLE
+* callbacks directly, with none of WiredTiger above them, and can run the same workload
+* against a plain pread/pwrite file system so the two can be compared like for like.
+*
+* Build (next to wt_uring.c, against liburing and WiredTiger):
+*
+*   gcc -O2 -DJEB_NO_MAIN -o wt_uring_bench wt_uring.c wt_uring_bench.c \
+*       -luring -lwiredtiger -lpthread
+*
+* e.g.
+*   ./wt_uring_bench -e uring -w randread -t 16 -b 4096 -q 64 -s 1G -d 10
+*   ./wt_uring_bench -e posix -w randread -t 16 -b 4096 -s 1G -d 10
+*
+* WiredTiger is only opened to get an extension API (config parsing, error messages) and a
+* home directory for the files; nothing goes through its btree, cache or log.
+*/
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "wiredtiger.h"
+#include "wt_uring.h"
+
+#define BENCH_WL_RANDREAD   0
+#define BENCH_WL_SEQREAD    1
+#define BENCH_WL_RANDWRITE  2
+#define BENCH_WL_SEQWRITE   3
+#define BENCH_WL_MIXED      4
+#define BENCH_WL_LOGAPPEND  5
+#define BENCH_WL_OPENSTAT   6
+
+static const char *bench_workloads[] =
+  {"randread", "seqread", "randwrite", "seqwrite", "mixed", "logappend", "openstat"};
+
+#define BENCH_ALIGN         4096
+#define BENCH_OPENSTAT_FILES 64
+
+/* log-linear latency histogram in ns, 8 sub-buckets per power of two (within 12.5%) */
+#define BENCH_HIST_SUB_BITS 3
+#define BENCH_HIST_BUCKETS  (40 << BENCH_HIST_SUB_BITS)
+
+typedef struct {
+    const char *engine;      // "uring" or "posix"
+    int workload;
+    uint32_t threads;
+    size_t block_size;
+    uint32_t queue_depth;    // uring SQ size; the posix engine has no queue
+    uint64_t file_size;
+    uint32_t duration;       // seconds
+    uint32_t read_pct;       // mixed: share of reads
+    uint32_t sync_every;     // logappend: fh_sync after this many appends
+    bool direct_io;
+    const char *home;
+    const char *uring_config; // anything else for the uring engine's config
+} BENCH_CFG;
+
+typedef struct {
+    pthread_t tid;
+    uint32_t id;
+    uint64_t rng;
+    uint64_t ops;
+    uint64_t bytes;
+    uint64_t errors;
+    uint64_t max;
+    uint64_t hist[BENCH_HIST_BUCKETS];
+} BENCH_THREAD;
+
+static BENCH_CFG cfg;
+static WT_FILE_SYSTEM *bench_fs;
+static WT_FILE_HANDLE *bench_fh;     // the data or log file the workload runs against
+static volatile bool bench_stop;
+static uint64_t bench_log_off;       // logappend: next append offset, shared by all threads
+
+/* ! [BENCH :: POSIX] */
+/*
+* The baseline: the same callbacks over pread/pwrite/fdatasync, opened with the same flags
+* WT's own posix layer would use, so the only difference is how the I/O gets to the kernel.
+*/
+typedef struct {
+    WT_FILE_HANDLE iface;
+    int fd;
+} POSIX_FILE_HANDLE;
+
+static int
+posix_fh_read(WT_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t offset, size_t len, void *buf) {
+    POSIX_FILE_HANDLE *pfh = (POSIX_FILE_HANDLE *)fh;
+    ssize_t n;
+
+    for (char *p = buf; len > 0; p += n, len -= (size_t)n, offset += n)
+        if ((n = pread(pfh->fd, p, len, offset)) <= 0)
+            return (n == 0 ? WT_ERROR : errno);
+    return (0);
+}
+
+static int
+posix_fh_write(WT_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t offset, size_t len, const void *buf) {
+    POSIX_FILE_HANDLE *pfh = (POSIX_FILE_HANDLE *)fh;
+    ssize_t n;
+
+    for (const char *p = buf; len > 0; p += n, len -= (size_t)n, offset += n)
+        if ((n = pwrite(pfh->fd, p, len, offset)) <= 0)
+            return (n == 0 ? EIO : errno);
+    return (0);
+}
+
+static int
+posix_fh_sync(WT_FILE_HANDLE *fh, WT_SESSION *session) {
+    return (fdatasync(((POSIX_FILE_HANDLE *)fh)->fd) == 0 ? 0 : errno);
+}
+
+static int
+posix_fh_size(WT_FILE_HANDLE *fh, WT_SESSION *session, wt_off_t *sizep) {
+    struct stat sb;
+
+    if (fstat(((POSIX_FILE_HANDLE *)fh)->fd, &sb) != 0)
+        return (errno);
+    *sizep = sb.st_size;
+    return (0);
+}
+
+static int
+posix_fh_close(WT_FILE_HANDLE *fh, WT_SESSION *session) {
+    POSIX_FILE_HANDLE *pfh = (POSIX_FILE_HANDLE *)fh;
+    int ret;
+
+    ret = close(pfh->fd) == 0 ? 0 : errno;
+    free(fh->name);
+    free(pfh);
+    return (ret);
+}
+
+static int
+posix_fs_open(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name,
+    WT_FS_OPEN_FILE_TYPE file_type, uint32_t flags, WT_FILE_HANDLE **file_handlep) {
+    POSIX_FILE_HANDLE *pfh;
+    int fd, open_flags;
+
+    open_flags = (flags & WT_FS_OPEN_READONLY ? O_RDONLY : O_RDWR) | O_CLOEXEC;
+    if (flags & WT_FS_OPEN_CREATE)
+        open_flags |= O_CREAT;
+    if (flags & WT_FS_OPEN_DIRECTIO)
+        open_flags |= O_DIRECT;
+    if (file_type == WT_FS_OPEN_FILE_TYPE_LOG && (flags & WT_FS_OPEN_DURABLE))
+        open_flags |= O_DSYNC;
+    if ((fd = open(name, open_flags, 0644)) < 0)
+        return (errno);
+
+    if ((pfh = calloc(1, sizeof(POSIX_FILE_HANDLE))) == NULL ||
+      (pfh->iface.name = strdup(name)) == NULL) {
+        free(pfh);
+        (void)close(fd);
+        return (ENOMEM);
+    }
+    pfh->fd = fd;
+    pfh->iface.file_system = fs;
+    pfh->iface.close = posix_fh_close;
+    pfh->iface.fh_read = posix_fh_read;
+    pfh->iface.fh_size = posix_fh_size;
+    pfh->iface.fh_sync = posix_fh_sync;
+    pfh->iface.fh_write = posix_fh_write;
+    *file_handlep = (WT_FILE_HANDLE *)pfh;
+    return (0);
+}
+
+static int
+posix_fs_exist(WT_FILE_SYSTEM *fs, WT_SESSION *session, const char *name, bool *existp) {
+    struct stat sb;
+
+    if (stat(name, &sb) == 0) {
+        *existp = true;
+        return (0);
+    }
+    *existp = false;
+    return (errno == ENOENT ? 0 : errno);
+}
+
+static int
+posix_fs_terminate(WT_FILE_SYSTEM *fs, WT_SESSION *session) {
+    free(fs);
+    return (0);
+}
+
+static int
+posix_fs_create(WT_FILE_SYSTEM **fsp) {
+    WT_FILE_SYSTEM *fs;
+
+    if ((fs = calloc(1, sizeof(WT_FILE_SYSTEM))) == NULL)
+        return (ENOMEM);
+    fs->fs_exist = posix_fs_exist;
+    fs->fs_open_file = posix_fs_open;
+    fs->terminate = posix_fs_terminate;
+    *fsp = fs;
+    return (0);
+}
+/* ! [BENCH :: POSIX] */
+
+static uint64_t
+bench_now_ns(void) {
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec);
+}
+
+/* xorshift64*, one stream per thread */
+static uint64_t
+bench_rand(BENCH_THREAD *t) {
+    t->rng ^= t->rng >> 12;
+    t->rng ^= t->rng << 25;
+    t->rng ^= t->rng >> 27;
+    return (t->rng * 0x2545F4914F6CDD1DULL);
+}
+
+static uint32_t
+bench_hist_bucket(uint64_t v) {
+    uint32_t idx, msb;
+
+    if (v < (1 << BENCH_HIST_SUB_BITS))
+        return ((uint32_t)v);
+    msb = 63 - (uint32_t)__builtin_clzll(v);
+    idx = ((msb - BENCH_HIST_SUB_BITS + 1) << BENCH_HIST_SUB_BITS) +
+      (uint32_t)((v >> (msb - BENCH_HIST_SUB_BITS)) & ((1 << BENCH_HIST_SUB_BITS) - 1));
+    return (idx < BENCH_HIST_BUCKETS ? idx : BENCH_HIST_BUCKETS - 1);
+}
+
+static uint64_t
+bench_hist_bucket_max(uint32_t idx) {
+    uint32_t shift;
+
+    if (idx < (1 << BENCH_HIST_SUB_BITS))
+        return (idx);
+    shift = (idx >> BENCH_HIST_SUB_BITS) - 1;
+    return ((((uint64_t)(idx & ((1 << BENCH_HIST_SUB_BITS) - 1)) + (1 << BENCH_HIST_SUB_BITS) + 1) << shift) - 1);
+}
+
+static uint64_t
+bench_quantile(const uint64_t *hist, uint64_t count, uint64_t max, double q) {
+    uint64_t seen = 0, target;
+
+    target = (uint64_t)(q * (double)count);
+    for (uint32_t i = 0; i < BENCH_HIST_BUCKETS; i++)
+        if ((seen += hist[i]) > target)
+            return (bench_hist_bucket_max(i) < max ? bench_hist_bucket_max(i) : max);
+    return (max);
+}
+
+/* a block-aligned offset inside this thread's slice (sequential) or the whole file (random) */
+static wt_off_t
+bench_offset(BENCH_THREAD *t, bool random, uint64_t *seq) {
+    uint64_t blocks, slice;
+
+    blocks = cfg.file_size / cfg.block_size;
+    if (random)
+        return ((wt_off_t)((bench_rand(t) % blocks) * cfg.block_size));
+    slice = blocks / cfg.threads;
+    return ((wt_off_t)((t->id * slice + (*seq)++ % slice) * cfg.block_size));
+}
+
+/* open, size and close one of the openstat files, then check another one exists */
+static int
+bench_openstat(BENCH_THREAD *t) {
+    WT_FILE_HANDLE *fh;
+    wt_off_t size;
+    char name[64];
+    bool exist;
+    int ret, tret;
+
+    (void)snprintf(name, sizeof(name), "bench_openstat.%" PRIu64, bench_rand(t) % BENCH_OPENSTAT_FILES);
+    if ((ret = bench_fs->fs_open_file(bench_fs, NULL, name, WT_FS_OPEN_FILE_TYPE_DATA, 0, &fh)) != 0)
+        return (ret);
+    // close either way, but a size failure is the one to report
+    ret = fh->fh_size(fh, NULL, &size);
+    if ((tret = fh->close(fh, NULL)) != 0 && ret == 0)
+        ret = tret;
+    if (ret != 0)
+        return (ret);
+    (void)snprintf(name, sizeof(name), "bench_openstat.%" PRIu64, bench_rand(t) % BENCH_OPENSTAT_FILES);
+    return (bench_fs->fs_exist(bench_fs, NULL, name, &exist));
+}
+
+static void *
+bench_thread(void *arg) {
+    BENCH_THREAD *t = arg;
+    uint64_t seq = 0, start, lat;
+    wt_off_t off;
+    void *buf;
+    int ret;
+    bool is_read;
+
+    if (posix_memalign(&buf, BENCH_ALIGN, cfg.block_size) != 0)
+        return (NULL);
+    memset(buf, 'a' + (int)t->id % 26, cfg.block_size);
+
+    while (!bench_stop) {
+        start = bench_now_ns();
+        switch (cfg.workload) {
+        case BENCH_WL_RANDREAD:
+        case BENCH_WL_SEQREAD:
+            off = bench_offset(t, cfg.workload == BENCH_WL_RANDREAD, &seq);
+            ret = bench_fh->fh_read(bench_fh, NULL, off, cfg.block_size, buf);
+            break;
+        case BENCH_WL_RANDWRITE:
+        case BENCH_WL_SEQWRITE:
+            off = bench_offset(t, cfg.workload == BENCH_WL_RANDWRITE, &seq);
+            ret = bench_fh->fh_write(bench_fh, NULL, off, cfg.block_size, buf);
+            break;
+        case BENCH_WL_MIXED:
+            off = bench_offset(t, true, &seq);
+            is_read = bench_rand(t) % 100 < cfg.read_pct;
+            ret = is_read ? bench_fh->fh_read(bench_fh, NULL, off, cfg.block_size, buf) :
+                            bench_fh->fh_write(bench_fh, NULL, off, cfg.block_size, buf);
+            break;
+        case BENCH_WL_LOGAPPEND:
+            off = (wt_off_t)__atomic_fetch_add(&bench_log_off, cfg.block_size, __ATOMIC_RELAXED);
+            ret = bench_fh->fh_write(bench_fh, NULL, off, cfg.block_size, buf);
+            if (ret == 0 && ++seq % cfg.sync_every == 0)
+                ret = bench_fh->fh_sync(bench_fh, NULL);
+            break;
+        case BENCH_WL_OPENSTAT:
+        default:
+            ret = bench_openstat(t);
+            break;
+        }
+        lat = bench_now_ns() - start;
+
+        ++t->ops;
+        if (ret != 0)
+            ++t->errors;
+        else if (cfg.workload != BENCH_WL_OPENSTAT)
+            t->bytes += cfg.block_size;
+        ++t->hist[bench_hist_bucket(lat)];
+        if (lat > t->max)
+            t->max = lat;
+    }
+    free(buf);
+    return (NULL);
+}
+
+/* create the files the workload needs: a filled data file, an empty log, or openstat's set */
+static int
+bench_setup(void) {
+    WT_FILE_HANDLE *fh;
+    WT_FS_OPEN_FILE_TYPE type;
+    uint32_t flags;
+    void *buf;
+    char name[64];
+    int ret;
+
+    if (cfg.workload == BENCH_WL_OPENSTAT) {
+        for (uint32_t i = 0; i < BENCH_OPENSTAT_FILES; i++) {
+            (void)snprintf(name, sizeof(name), "bench_openstat.%" PRIu32, i);
+            if ((ret = bench_fs->fs_open_file(
+              bench_fs, NULL, name, WT_FS_OPEN_FILE_TYPE_DATA, WT_FS_OPEN_CREATE, &fh)) != 0)
+                return (ret);
+            if ((ret = fh->close(fh, NULL)) != 0)
+                return (ret);
+        }
+        return (0);
+    }
+
+    flags = WT_FS_OPEN_CREATE | (cfg.direct_io ? WT_FS_OPEN_DIRECTIO : 0);
+    if (cfg.workload == BENCH_WL_LOGAPPEND) {
+        type = WT_FS_OPEN_FILE_TYPE_LOG;
+        flags |= WT_FS_OPEN_DURABLE;
+        (void)unlink("bench_log");
+        return (bench_fs->fs_open_file(bench_fs, NULL, "bench_log", type, flags, &bench_fh));
+    }
+
+    type = WT_FS_OPEN_FILE_TYPE_DATA;
+    if (cfg.workload == BENCH_WL_RANDREAD || cfg.workload == BENCH_WL_MIXED ||
+      cfg.workload == BENCH_WL_RANDWRITE)
+        flags |= WT_FS_OPEN_ACCESS_RAND;
+    else
+        flags |= WT_FS_OPEN_ACCESS_SEQ;
+    if ((ret = bench_fs->fs_open_file(bench_fs, NULL, "bench_data", type, flags, &bench_fh)) != 0)
+        return (ret);
+
+    // fill it in 1MB writes so reads don't hit holes
+    if (posix_memalign(&buf, BENCH_ALIGN, 1 << 20) != 0)
+        return (ENOMEM);
+    memset(buf, 'x', 1 << 20);
+    for (uint64_t off = 0; off < cfg.file_size && ret == 0; off += 1 << 20)
+        ret = bench_fh->fh_write(bench_fh, NULL, (wt_off_t)off, 1 << 20, buf);
+    free(buf);
+    if (ret == 0)
+        ret = bench_fh->fh_sync(bench_fh, NULL);
+    return (ret);
+}
+
+static void
+bench_report(BENCH_THREAD *threads, double secs) {
+    static uint64_t hist[BENCH_HIST_BUCKETS];
+    uint64_t ops = 0, bytes = 0, errors = 0, max = 0;
+
+    for (uint32_t i = 0; i < cfg.threads; i++) {
+        ops += threads[i].ops;
+        bytes += threads[i].bytes;
+        errors += threads[i].errors;
+        if (threads[i].max > max)
+            max = threads[i].max;
+        for (uint32_t b = 0; b < BENCH_HIST_BUCKETS; b++)
+            hist[b] += threads[i].hist[b];
+    }
+
+    printf("engine=%s workload=%s threads=%" PRIu32 " block=%zu queue_depth=%" PRIu32
+      " file=%" PRIu64 " direct=%d duration=%.1fs\n",
+      cfg.engine, bench_workloads[cfg.workload], cfg.threads, cfg.block_size, cfg.queue_depth,
+      cfg.file_size, cfg.direct_io, secs);
+    printf("ops %" PRIu64 "  errors %" PRIu64 "  ops/s %.0f  MB/s %.1f\n",
+      ops, errors, ops / secs, bytes / secs / (1024 * 1024));
+    if (ops == 0)
+        return;
+    printf("latency us: p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+      bench_quantile(hist, ops, max, 0.5) / 1000.0, bench_quantile(hist, ops, max, 0.99) / 1000.0,
+      bench_quantile(hist, ops, max, 0.999) / 1000.0, max / 1000.0);
+}
+
+/* 4096, 64K, 1M, 1G */
+static uint64_t
+bench_parse_size(const char *s) {
+    char *end;
+    uint64_t v;
+
+    v = strtoull(s, &end, 10);
+    switch (*end) {
+    case 'k': case 'K': return (v << 10);
+    case 'm': case 'M': return (v << 20);
+    case 'g': case 'G': return (v << 30);
+    default: return (v);
+    }
+}
+
+static void
+bench_usage(void) {
+    fprintf(stderr,
+      "usage: wt_uring_bench [-e uring|posix] [-w workload] [-t threads] [-b block_size]\n"
+      "    [-q queue_depth] [-s file_size] [-d seconds] [-r read_pct] [-S sync_every] [-D]\n"
+      "    [-h home] [-c uring_config]\n"
+      "workloads: randread seqread randwrite seqwrite mixed logappend openstat\n");
+    exit(1);
+}
+
+int
+main(int argc, char *argv[]) {
+    BENCH_THREAD *threads;
+    WT_CONNECTION *conn;
+    char uring_config[1024];
+    uint64_t start;
+    double secs;
+    int ch, ret;
+
+    cfg.engine = "uring";
+    cfg.workload = BENCH_WL_RANDREAD;
+    cfg.threads = 4;
+    cfg.block_size = 4096;
+    cfg.queue_depth = 64;
+    cfg.file_size = 256ULL << 20;
+    cfg.duration = 10;
+    cfg.read_pct = 70;
+    cfg.sync_every = 1;
+    cfg.home = "/tmp/wt_uring_bench";
+    cfg.uring_config = "";
+
+    while ((ch = getopt(argc, argv, "e:w:t:b:q:s:d:r:S:Dh:c:")) != -1)
+        switch (ch) {
+        case 'e':
+            cfg.engine = optarg;
+            break;
+        case 'w':
+            for (cfg.workload = 0; cfg.workload <= BENCH_WL_OPENSTAT; cfg.workload++)
+                if (strcmp(optarg, bench_workloads[cfg.workload]) == 0)
+                    break;
+            if (cfg.workload > BENCH_WL_OPENSTAT)
+                bench_usage();
+            break;
+        case 't':
+            cfg.threads = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'b':
+            cfg.block_size = (size_t)bench_parse_size(optarg);
+            break;
+        case 'q':
+            cfg.queue_depth = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 's':
+            cfg.file_size = bench_parse_size(optarg);
+            break;
+        case 'd':
+            cfg.duration = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'r':
+            cfg.read_pct = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'S':
+            cfg.sync_every = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'D':
+            cfg.direct_io = true;
+            break;
+        case 'h':
+            cfg.home = optarg;
+            break;
+        case 'c':
+            cfg.uring_config = optarg;
+            break;
+        default:
+            bench_usage();
+        }
+    if (cfg.threads == 0 || cfg.block_size == 0 || cfg.sync_every == 0 ||
+      cfg.file_size < cfg.block_size * cfg.threads || (cfg.direct_io && cfg.block_size % BENCH_ALIGN != 0))
+        bench_usage();
+
+    (void)mkdir(cfg.home, 0755);
+    if ((ret = wiredtiger_open(cfg.home, NULL, "create", &conn)) != 0) {
+        fprintf(stderr, "failed to open %s: %s\n", cfg.home, wiredtiger_strerror(ret));
+        return (1);
+    }
+    // both engines take names relative to the home, like WT hands them down
+    if (chdir(cfg.home) != 0) {
+        fprintf(stderr, "failed to chdir to %s: %s\n", cfg.home, strerror(errno));
+        return (1);
+    }
+
+    if (strcmp(cfg.engine, "posix") == 0)
+        ret = posix_fs_create(&bench_fs);
+    else if (strcmp(cfg.engine, "uring") == 0) {
+        (void)snprintf(uring_config, sizeof(uring_config), "queue_depth=%" PRIu32 "%s%s",
+          cfg.queue_depth, cfg.uring_config[0] != '\0' ? "," : "", cfg.uring_config);
+        ret = wt_uring_file_system_create(conn, uring_config, &bench_fs);
+    } else
+        bench_usage();
+    if (ret != 0) {
+        fprintf(stderr, "failed to create the %s file system: %s\n", cfg.engine, wiredtiger_strerror(ret));
+        return (1);
+    }
+
+    if ((ret = bench_setup()) != 0) {
+        fprintf(stderr, "setup failed: %s\n", wiredtiger_strerror(ret));
+        return (1);
+    }
+
+    if ((threads = calloc(cfg.threads, sizeof(BENCH_THREAD))) == NULL)
+        return (1);
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < cfg.threads; i++) {
+        threads[i].id = i;
+        threads[i].rng = 0x9E3779B97F4A7C15ULL * (i + 1);
+        if ((ret = pthread_create(&threads[i].tid, NULL, bench_thread, &threads[i])) != 0) {
+            fprintf(stderr, "failed to start thread %" PRIu32 ": %s\n", i, strerror(ret));
+            return (1);
+        }
+    }
+    sleep(cfg.duration);
+    bench_stop = true;
+    for (uint32_t i = 0; i < cfg.threads; i++)
+        (void)pthread_join(threads[i].tid, NULL);
+    secs = (bench_now_ns() - start) / 1e9;
+
+    bench_report(threads, secs);
+
+    if (bench_fh != NULL)
+        (void)bench_fh->close(bench_fh, NULL);
+    (void)bench_fs->terminate(bench_fs, NULL);
+    (void)conn->close(conn, NULL);
+    free(threads);
+    return (0);
+}